@@ -0,0 +1,52 @@
+#ifndef ENTRYBITMAP_H
+#define ENTRYBITMAP_H
+
+#include <QVector>
+#include <QList>
+
+// 条目下标位图：每个条目占1位，支持集合运算与“下一个/上一个”查询
+// 查询按64位字跳过空白区域，10万条目只占约12KB
+class EntryBitmap {
+public:
+    EntryBitmap() = default;
+    explicit EntryBitmap(int size);
+
+    int size() const { return m_size; }
+    void resize(int size);
+    void clear();
+
+    bool test(int index) const;
+    void set(int index, bool value = true);
+    void reset(int index) { set(index, false); }
+
+    // 插入/删除一个位置，其后的位整体移动
+    void append(bool value);
+    void removeAt(int index);
+    // 删除多个位置（升序且不重复），一次遍历压缩
+    void removeIndices(const QVector<int> &indices);
+
+    int count() const;
+    bool isEmpty() const;
+
+    // 返回 >= from / <= from 的第一个置位下标，没有则返回 -1
+    int nextSetBit(int from) const;
+    int previousSetBit(int from) const;
+
+    QList<int> toList() const;
+
+    EntryBitmap &operator&=(const EntryBitmap &other);
+    EntryBitmap &operator|=(const EntryBitmap &other);
+    EntryBitmap &subtract(const EntryBitmap &other);   // this & ~other
+
+    friend EntryBitmap operator&(EntryBitmap left, const EntryBitmap &right) { return left &= right; }
+    friend EntryBitmap operator|(EntryBitmap left, const EntryBitmap &right) { return left |= right; }
+
+private:
+    static int wordCount(int bits) { return (bits + 63) / 64; }
+    void clearPadding();
+
+    QVector<quint64> m_words;
+    int m_size = 0;
+};
+
+#endif // ENTRYBITMAP_H
@@ -0,0 +1,147 @@
+#ifndef ENTRYSTORE_H
+#define ENTRYSTORE_H
+
+#include <QList>
+#include <QMutex>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <iterator>
+#include <memory>
+
+// TS文件条目状态枚举
+enum class TranslationState {
+    Unfinished,  // 未完成
+    Finished,    // 已完成
+    Vanished,    // 已消失
+    Obsolete     // 已废弃
+};
+
+// TS文件条目结构
+struct TsEntry {
+    QString source;             // 源文本
+    QString translation;        // 翻译文本
+    TranslationState state = TranslationState::Unfinished; // 翻译状态
+    QStringList comments;       // 注释
+    QStringList locations;      // 位置信息 (filename:line)
+    QString context;            // 上下文信息
+};
+
+// 分块的写时复制条目存储：条目按每块 256 条保存，版本只是块指针表。
+// 后台线程通过 snapshot() 取得不可变的版本，之后写入只复制被快照共享的块，
+// 没有快照时原地修改。只有一个写入线程（GUI 线程），其读取无需加锁
+class EntryStore {
+public:
+    static constexpr int ChunkShift = 8;
+    static constexpr int ChunkSize = 1 << ChunkShift;
+    static constexpr int ChunkMask = ChunkSize - 1;
+
+private:
+    using Chunk = QVector<TsEntry>;
+
+    struct Version {
+        QVector<std::shared_ptr<Chunk>> chunks;     // 除最后一块外都是满块
+        int size = 0;
+        quint64 number = 0;
+
+        const TsEntry &at(int index) const { return chunks.at(index >> ChunkShift)->at(index & ChunkMask); }
+    };
+
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = TsEntry;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const TsEntry *;
+        using reference = const TsEntry &;
+
+        const_iterator(const Version *version, int index) : m_version(version), m_index(index) {}
+
+        reference operator*() const { return m_version->at(m_index); }
+        pointer operator->() const { return &m_version->at(m_index); }
+        const_iterator &operator++() { ++m_index; return *this; }
+        bool operator==(const const_iterator &other) const { return m_index == other.m_index; }
+        bool operator!=(const const_iterator &other) const { return m_index != other.m_index; }
+
+    private:
+        const Version *m_version;
+        int m_index;
+    };
+
+    // 某一时刻的只读版本，可以跨线程传递与持有
+    class Snapshot {
+    public:
+        Snapshot() = default;
+
+        int size() const { return m_version ? m_version->size : 0; }
+        bool isEmpty() const { return size() == 0; }
+        const TsEntry &at(int index) const { return m_version->at(index); }
+        const TsEntry &operator[](int index) const { return at(index); }
+        // 每次写入后版本号递增，用于判断结果是否已过期
+        quint64 version() const { return m_version ? m_version->number : 0; }
+
+        const_iterator begin() const { return const_iterator(m_version.get(), 0); }
+        const_iterator end() const { return const_iterator(m_version.get(), size()); }
+
+        QList<TsEntry> toList() const;
+
+    private:
+        friend class EntryStore;
+        explicit Snapshot(std::shared_ptr<const Version> version) : m_version(std::move(version)) {}
+
+        std::shared_ptr<const Version> m_version;
+    };
+
+    EntryStore();
+    EntryStore(const EntryStore &) = delete;
+    EntryStore &operator=(const EntryStore &) = delete;
+
+    // 以下读取只能在写入线程调用
+    int size() const { return m_current->size; }
+    bool isEmpty() const { return m_current->size == 0; }
+    const TsEntry &at(int index) const { return m_current->at(index); }
+    const TsEntry &operator[](int index) const { return at(index); }
+    quint64 version() const { return m_current->number; }
+    const_iterator begin() const { return const_iterator(m_current.get(), 0); }
+    const_iterator end() const { return const_iterator(m_current.get(), m_current->size); }
+    QList<TsEntry> toList() const;
+
+    // 可在任意线程调用
+    Snapshot snapshot() const;
+
+    // 写入：每次调用发布一个新版本
+    void assign(const QList<TsEntry> &entries);
+    void clear();
+    void append(const TsEntry &entry);
+    void removeAt(int index);
+    // 删除多个条目（升序且不重复），一次压缩其后的块并只发布一个版本
+    void removeMany(const QVector<int> &indices);
+    void replace(int index, const TsEntry &entry);
+    template <typename Function>
+    void update(int index, Function function) {
+        QMutexLocker locker(&m_mutex);
+        function(detachEntry(index));
+    }
+    // 一次加锁、发布一个版本内修改多个条目：function(条目, indices 中的位置)
+    template <typename Function>
+    void updateMany(const QVector<int> &indices, Function function) {
+        QMutexLocker locker(&m_mutex);
+        detachVersion();
+        for (int i = 0; i < indices.size(); ++i) {
+            const int index = indices.at(i);
+            function(detachChunk(index >> ChunkShift)[index & ChunkMask], i);
+        }
+    }
+
+private:
+    // 以下由持有 m_mutex 的写入调用
+    Version &detachVersion();
+    Chunk &detachChunk(int chunk);
+    TsEntry &detachEntry(int index);
+
+    mutable QMutex m_mutex;
+    std::shared_ptr<Version> m_current;
+};
+
+#endif // ENTRYSTORE_H
@@ -0,0 +1,78 @@
+#ifndef LOGMODEL_H
+#define LOGMODEL_H
+
+#include <QAbstractListModel>
+#include <QVector>
+#include <QTimer>
+#include <QThread>
+#include <QFile>
+
+// 异步日志文件：在独立线程中追加写入完整日志
+class LogFileSink : public QObject {
+    Q_OBJECT
+public:
+    explicit LogFileSink(const QString &filePath);
+    ~LogFileSink() override;
+
+    QString filePath() const { return m_filePath; }
+    bool isOpen() const { return m_openSucceeded; }
+
+    // 可在任意线程调用
+    void appendLines(const QStringList &lines);
+
+private:
+    void writeLines(const QStringList &lines);
+
+    QString m_filePath;
+    QThread m_thread;
+    QObject *m_writer;
+    QFile *m_file;
+    bool m_openSucceeded = false;
+};
+
+// 固定容量的环形日志模型，追加操作按帧合并为一次视图更新
+class LogModel : public QAbstractListModel {
+    Q_OBJECT
+public:
+    explicit LogModel(int capacity = 10000, QObject *parent = nullptr);
+    ~LogModel() override;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    void appendMessage(const QString &message);
+    void appendError(const QString &error);
+    void clear();
+
+    int capacity() const { return m_capacity; }
+
+    // 设置为空路径时关闭文件记录
+    bool setFileSink(const QString &filePath);
+    QString fileSinkPath() const;
+
+signals:
+    void rowsFlushed();
+
+private slots:
+    void flush();
+
+private:
+    struct LogRecord {
+        QString text;
+        bool error = false;
+    };
+
+    void append(const QString &text, bool error);
+    const LogRecord &recordAt(int row) const;
+
+    int m_capacity;
+    QVector<LogRecord> m_ring;
+    int m_start = 0;
+    int m_size = 0;
+
+    QVector<LogRecord> m_pending;
+    QTimer m_flushTimer;
+    LogFileSink *m_sink = nullptr;
+};
+
+#endif // LOGMODEL_H
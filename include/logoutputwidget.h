@@ -2,9 +2,11 @@
 #define LOGOUTPUTWIDGET_H
 
 #include <QWidget>
-#include <QTextEdit>
+#include <QListView>
 #include <QPushButton>
+#include <QCheckBox>
 #include <QVBoxLayout>
+#include "logmodel.h"
 
 class LogOutputWidget : public QWidget {
     Q_OBJECT
@@ -15,9 +17,15 @@ public:
     void appendError(const QString &error);
     void clearLog();
 
+private slots:
+    void onRowsFlushed();
+    void onFileSinkToggled(bool enabled);
+
 private:
-    QTextEdit *m_logTextEdit;
+    LogModel *m_logModel;
+    QListView *m_logView;
     QPushButton *m_clearButton;
+    QCheckBox *m_fileSinkCheck;
 };
 
-#endif // LOGOUTPUTWIDGET_H
\ No newline at end of file
+#endif // LOGOUTPUTWIDGET_H
@@ -5,28 +5,46 @@
 #include "tsdetailwidget.h"
 #include "tsfilehandler.h"
 #include "logoutputwidget.h"
+#include "metricswidget.h"
+#include "qawidget.h"
 #include <QFileDialog>
 #include <QProgressDialog>
 #include <QToolBar>
 #include <QProgressBar>
+#include <QPropertyAnimation>
+#include <QTimer>
+#include "progressaggregator.h"
 class MainWindow : public QMainWindow {
     Q_OBJECT
 public:
     MainWindow(QWidget *parent = nullptr);
+protected:
+    void closeEvent(QCloseEvent *event) override;
 private slots:
     void openTranslationSettings();
     void onBatchTranslationRequested();
 
-    void onSingleTranslationCompleted(const QString &context, const QString &source, const QString &translation);
+    void onBatchTextTranslated(int batchIndex, const QString &translation, bool intact);
+    void applyPendingTranslations();
 
     void onBatchTranslationCompleted(const QMap<QString, QString> &results);
     void onTranslationError(const QString &errorMessage, const QString &sourceText);
+    void onPlaceholderMismatch(const QString &source, const QString &translation, const QStringList &missingTokens);
     void onEngineChanged(int index);
+    void onTraceToggled(bool enabled);
+    void selectNextUnfinished();
+    void selectPreviousUnfinished();
+    void releaseCurrentFile();
+    void releaseFiles();
+    void mergeFromFile();
+    void streamTranslateFile();
     void logMessage(const QString &message);
     void logError(const QString &error);
 private slots:
     void onBatchProgress(int current, int total);
 
+    void onAggregatedProgress(int done, int total, double itemsPerSecond, qint64 etaMs);
+
     void setProgressBarColor(const QString &color);
 
     void onBatchTranslationCanceled();
@@ -38,6 +56,8 @@ private slots:
 private:
     void setupUi();
     void loadTsFile(const QString &filePath);
+    void navigateEntries(const EntryBitmap &set, bool forward);
+    void prefetchAfter(int index);
 
     QString stateToString(TranslationState state) const;
 
@@ -46,14 +66,24 @@ private:
     TsTreeWidget *m_treeWidget;
     TsDetailWidget *m_detailWidget;
     LogOutputWidget *m_logWidget;
+    MetricsWidget *m_metricsWidget;
+    QaChecker *m_qaChecker;
+    QaWidget *m_qaWidget;
     TsFileHandler m_fileHandler;
     QString m_currentFilePath;
     TranslationService *m_translationService;
     QToolBar *m_translationToolBar;
     QComboBox *m_engineCombo;
+    int m_prefetchCount;
+    QVector<int> m_batchEntries;    // 批量翻译中的文本下标 -> 条目下标
+    QVector<TsFileHandler::TranslationUpdate> m_pendingUpdates;
+    QTimer *m_applyTimer;
 
     QProgressBar *m_statusProgressBar;
     QLabel *m_statusLabel;
+    QPropertyAnimation *m_progressAnimation;
+    ProgressAggregator *m_progressAggregator;
+    QString m_progressColor;
 };
 
 
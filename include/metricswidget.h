@@ -0,0 +1,30 @@
+#ifndef METRICSWIDGET_H
+#define METRICSWIDGET_H
+
+#include <QWidget>
+#include <QTableWidget>
+#include <QPushButton>
+#include <QTimer>
+
+// 性能指标面板：按引擎显示延迟分位数、进行中请求数与吞吐量
+class MetricsWidget : public QWidget {
+    Q_OBJECT
+public:
+    explicit MetricsWidget(QWidget *parent = nullptr);
+
+public slots:
+    void refresh();
+    void exportJson();
+
+protected:
+    void showEvent(QShowEvent *event) override;
+    void hideEvent(QHideEvent *event) override;
+
+private:
+    QTableWidget *m_table;
+    QPushButton *m_exportButton;
+    QPushButton *m_resetButton;
+    QTimer m_refreshTimer;
+};
+
+#endif // METRICSWIDGET_H
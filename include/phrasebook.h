@@ -0,0 +1,59 @@
+#ifndef PHRASEBOOK_H
+#define PHRASEBOOK_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+#include <QChar>
+#include <memory>
+
+// 离线短语库：载入 Qt Linguist 短语库（.qph）与 CSV 词汇表（每行 原文,译文），
+// 在请求网络引擎之前按遮蔽后的文本查找译文。原文与译文都经过 PlaceholderMasker 遮蔽，
+// 占位符不同但结构相同的文本也能命中；精确匹配失败时再按规范化形式
+// （忽略大小写与多余空白、去掉结尾的冒号和省略号）匹配
+class Phrasebook {
+public:
+    // 载入并合并多个文件，先列出的文件优先；相同文件列表（且文件未修改）共用同一个实例。
+    // 有文件无法读取时 errorMessage 说明原因，其余文件照常载入
+    static std::shared_ptr<const Phrasebook> open(const QStringList &fileNames, QString *errorMessage = nullptr);
+
+    // masked 为遮蔽后的文本或句段，命中时 translation 为使用相同哨兵编号的遮蔽译文
+    bool lookup(const QString &masked, QString &translation) const;
+    int size() const { return m_size; }
+
+private:
+    // 扁平字典树：每个节点的子边在 m_labels/m_children 中连续存放并按字符排序，查找时二分
+    class Trie {
+    public:
+        // keys 已排序且不重复，values 与之一一对应
+        void build(const QStringList &keys, const QVector<int> &values);
+        int find(const QString &key) const;
+
+    private:
+        struct Node {
+            int firstEdge = 0;
+            int edgeCount = 0;
+            int value = -1;
+        };
+        QVector<Node> m_nodes;
+        QVector<QChar> m_labels;
+        QVector<int> m_children;
+    };
+
+    struct Phrase {
+        QString source;
+        QString target;
+    };
+
+    Phrasebook() = default;
+    static bool readQph(const QString &fileName, QList<Phrase> &phrases, QString &error);
+    static bool readCsv(const QString &fileName, QList<Phrase> &phrases, QString &error);
+    void build(const QList<Phrase> &phrases);
+
+    Trie m_exact;
+    Trie m_normalized;
+    QStringList m_translations;
+    int m_size = 0;
+};
+
+#endif // PHRASEBOOK_H
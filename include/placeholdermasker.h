@@ -0,0 +1,31 @@
+#ifndef PLACEHOLDERMASKER_H
+#define PLACEHOLDERMASKER_H
+
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+// 翻译前的占位符/标记遮蔽：把 %1、%n、printf 格式符、HTML 标签与实体替换为 {n} 哨兵，
+// 去掉 & 快捷键标记；译文返回后再还原，并检查哨兵是否全部保留
+class PlaceholderMasker {
+public:
+    struct MaskedText {
+        QString source;                 // 原文
+        QString masked;                 // 实际发送给引擎的文本
+        QStringList tokens;             // tokens[i] 对应哨兵 {i}
+        QChar accelerator;              // 被移除的快捷键字符（&F 中的 F）
+        bool needsTranslation = true;   // 去掉哨兵后是否仍有文字需要翻译
+    };
+
+    static MaskedText mask(const QString &text);
+    // 对整批文本做一次遮蔽，复用同一个已编译的正则
+    static QVector<MaskedText> maskAll(const QStringList &texts);
+
+    // 还原译文到 result，返回丢失的原始占位符（为空表示全部保留）
+    static QStringList unmask(const MaskedText &masked, const QString &translated, QString &result);
+
+private:
+    static QString restoreAccelerator(const QString &translated, QChar accelerator);
+};
+
+#endif // PLACEHOLDERMASKER_H
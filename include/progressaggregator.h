@@ -0,0 +1,45 @@
+#ifndef PROGRESSAGGREGATOR_H
+#define PROGRESSAGGREGATOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QTimer>
+#include <QElapsedTimer>
+
+// 进度汇总：接收任意数量任务的高频进度事件，每帧最多发出一次汇总结果
+class ProgressAggregator : public QObject {
+    Q_OBJECT
+public:
+    explicit ProgressAggregator(QObject *parent = nullptr);
+
+    void report(quint64 jobId, int current, int total);
+    // 任务完成：计为全部完成；所有任务都完成后发出最终进度并清空
+    void finishJob(quint64 jobId);
+    // 任务取消：不再计入汇总
+    void cancelJob(quint64 jobId);
+
+    bool isActive() const { return !m_jobs.isEmpty(); }
+
+signals:
+    // itemsPerSecond 为开始以来的平均吞吐量，etaMs 为预计剩余时间（未知时为 -1）
+    void progressChanged(int done, int total, double itemsPerSecond, qint64 etaMs);
+
+private slots:
+    void emitProgress();
+
+private:
+    struct JobProgress {
+        int current = 0;
+        int total = 0;
+        int startValue = 0;
+        bool finished = false;
+    };
+
+    void clearIfFinished();
+
+    QHash<quint64, JobProgress> m_jobs;
+    QTimer m_frameTimer;
+    QElapsedTimer m_clock;
+};
+
+#endif // PROGRESSAGGREGATOR_H
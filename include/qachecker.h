@@ -0,0 +1,75 @@
+#ifndef QACHECKER_H
+#define QACHECKER_H
+
+#include <QObject>
+#include <QMap>
+#include <QSet>
+#include <QThreadPool>
+#include <QTimer>
+#include <QVector>
+#include "tsfilehandler.h"
+
+// 译文质量检查：规则只依赖单个条目，条目较多时按块在私有线程池中并行检查，
+// 结果回到 GUI 线程后再替换；条目修改、新增或删除后只重新检查受影响的条目
+class QaChecker : public QObject {
+    Q_OBJECT
+public:
+    enum Rule {
+        PlaceholderMismatch,    // %1、%n、printf 格式符与原文不一致
+        AcceleratorLost,        // 原文有 & 快捷键，译文没有
+        TagMismatch,            // HTML 标签与原文不一致或不配对
+        UntranslatedCopy,       // 译文与原文完全相同
+        LengthRatio             // 译文长度与原文相差过大
+    };
+    Q_ENUM(Rule)
+
+    struct Issue {
+        int entry;
+        Rule rule;
+        QString message;
+    };
+
+    explicit QaChecker(TsFileHandler *fileHandler, QObject *parent = nullptr);
+    ~QaChecker() override;
+
+    static QString ruleName(Rule rule);
+    static QList<Issue> checkEntry(int index, const TsEntry &entry);
+
+    // 按条目顺序返回全部问题
+    QList<Issue> issues() const;
+    int issueCount() const { return m_issueCount; }
+    bool isChecking() const { return m_checking; }
+
+public slots:
+    void checkAll();
+
+signals:
+    void issuesChanged();
+    void checkingChanged(bool checking);
+
+private:
+    void onEntriesReset();
+    void onEntryChanged(int index);
+    void onEntriesChanged(int first, int last);
+    void onEntriesRemoved(const QVector<int> &indices);
+    void recheckPending();
+    // 检查给定条目：较少时直接检查，否则在线程池中分块检查，完成后调用 finishCheck。
+    // 新的检查开始后，尚未返回的旧结果被丢弃
+    void startCheck(const QVector<int> &indices, bool all);
+    void finishCheck(const QVector<int> &indices, bool all, const QMap<int, QList<Issue>> &result);
+    void setChecking(bool checking);
+
+    TsFileHandler *m_fileHandler;
+    QMap<int, QList<Issue>> m_issues;   // 条目 -> 问题
+    int m_issueCount = 0;
+    QSet<int> m_pending;
+    QTimer m_recheckTimer;
+
+    quint64 m_generation = 0;           // 每次开始或作废检查时递增
+    bool m_checking = false;
+    bool m_checkingAll = false;
+    QVector<int> m_checkingIndices;     // 进行中的部分检查，条目删除后需要改为重新检查
+    QThreadPool m_pool;
+};
+
+#endif // QACHECKER_H
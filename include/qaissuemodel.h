@@ -0,0 +1,36 @@
+#ifndef QAISSUEMODEL_H
+#define QAISSUEMODEL_H
+
+#include <QAbstractTableModel>
+#include <QList>
+#include "qachecker.h"
+
+// 质量检查问题列表的表格模型：只保存问题本身，上下文与源文本在显示时从条目中读取
+class QaIssueModel : public QAbstractTableModel {
+    Q_OBJECT
+public:
+    enum Column {
+        ContextColumn,
+        SourceColumn,
+        RuleColumn,
+        MessageColumn,
+        ColumnCount
+    };
+
+    explicit QaIssueModel(TsFileHandler *fileHandler, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+
+    void setIssues(const QList<QaChecker::Issue> &issues);
+    // 该行问题所属的条目下标，行号无效时返回 -1
+    int entryAt(int row) const;
+
+private:
+    TsFileHandler *m_fileHandler;
+    QList<QaChecker::Issue> m_issues;
+};
+
+#endif // QAISSUEMODEL_H
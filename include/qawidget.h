@@ -0,0 +1,43 @@
+#ifndef QAWIDGET_H
+#define QAWIDGET_H
+
+#include <QWidget>
+#include <QComboBox>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+#include <QTableView>
+#include <QTimer>
+#include "qachecker.h"
+#include "qaissuemodel.h"
+
+// 质量检查面板：列出 QaChecker 发现的问题，可按规则与文本筛选，双击跳转到对应条目
+class QaWidget : public QWidget {
+    Q_OBJECT
+public:
+    QaWidget(QaChecker *checker, TsFileHandler *fileHandler, QWidget *parent = nullptr);
+
+public slots:
+    void refresh();
+
+signals:
+    void entryActivated(int entryIndex);
+
+protected:
+    void showEvent(QShowEvent *event) override;
+
+private:
+    void scheduleRefresh();
+
+    QaChecker *m_checker;
+    TsFileHandler *m_fileHandler;
+    QComboBox *m_ruleCombo;
+    QLineEdit *m_filterEdit;
+    QPushButton *m_checkButton;
+    QLabel *m_countLabel;
+    QTableView *m_table;
+    QaIssueModel *m_model;
+    QTimer m_refreshTimer;
+};
+
+#endif // QAWIDGET_H
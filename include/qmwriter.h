@@ -0,0 +1,26 @@
+#ifndef QMWRITER_H
+#define QMWRITER_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include "tsfilehandler.h"
+
+// 由内存中的条目直接生成 .qm 文件，无需再调用 lrelease 重新解析 .ts
+// 输出与 lrelease 默认模式一致：不压缩，包含有译文的未完成条目，跳过已废弃/已消失条目
+class QmWriter {
+public:
+    static QByteArray compile(const QString &language, const EntryStore::Snapshot &entries);
+    static bool write(const QString &qmPath, const QString &language, const EntryStore::Snapshot &entries);
+
+    static QString qmPath(const QString &tsPath);
+    // 在线程池中并行加载并发布多个 .ts 文件，.qm 写在各自旁边；返回失败的文件
+    static QStringList releaseFiles(const QStringList &tsFiles);
+
+private:
+    // 语言的复数规则，与 lrelease 写入的 NumerusRules 段相同；未收录的语言不写该段
+    static QByteArray numerusRules(const QString &language);
+};
+
+#endif // QMWRITER_H
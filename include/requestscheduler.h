@@ -0,0 +1,66 @@
+#ifndef REQUESTSCHEDULER_H
+#define REQUESTSCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QPointer>
+#include <QTimer>
+#include <functional>
+#include "translationservice.h"
+
+// 按引擎限速的请求调度器，所有 TranslationService 实例共用（GUI线程）。
+// 同一引擎的请求按通道优先级放行：交互 > 可见上下文 > 后台批量 > 预取。
+// 有频率限制的引擎为交互通道预留一部分额度：其余通道的发送间隔更长，
+// 用户点击最多等待一个间隔，而不是排在整批请求之后
+class RequestScheduler : public QObject {
+    Q_OBJECT
+public:
+    enum Lane {
+        Interactive,    // 用户点击的单条翻译
+        Visible,        // 批量翻译中当前选中上下文的句段
+        Background,     // 其余批量翻译
+        Prefetch,       // 审阅预取
+        LaneCount
+    };
+
+    static RequestScheduler *instance();
+
+    // 轮到该请求时调用 send；可以立即放行时同步调用。owner 销毁后未放行的请求被丢弃
+    void submit(TranslationService::Engine engine, Lane lane, QObject *owner, std::function<void()> send);
+    // 丢弃 owner 在该通道中尚未放行的请求
+    void cancel(QObject *owner, Lane lane);
+
+    // 各引擎的剩余字符额度（-1 表示不限），所有服务实例共用同一份计数。
+    // 派发请求时的扣减只在内存中进行，稍后合并写入设置，程序退出前写入最后的值
+    qint64 remainingQuota(TranslationService::Engine engine) const;
+    void setRemainingQuota(TranslationService::Engine engine, qint64 characters);
+    // characters 为负时退回额度（合并到其他请求、没有单独计费的请求）
+    void consumeQuota(TranslationService::Engine engine, qint64 characters);
+    void flushQuota();
+
+private:
+    explicit RequestScheduler(QObject *parent = nullptr);
+
+    struct Job {
+        QPointer<QObject> owner;
+        std::function<void()> send;
+    };
+
+    struct EngineQueue {
+        QList<Job> lanes[LaneCount];
+        qint64 lastSendUs = -1;
+        QTimer *timer = nullptr;
+        bool pumping = false;
+    };
+
+    static qint64 intervalUs(TranslationService::Engine engine, Lane lane);
+    void pump(TranslationService::Engine engine);
+
+    QMap<TranslationService::Engine, EngineQueue> m_engines;
+    QMap<TranslationService::Engine, qint64> m_quotas;
+    QTimer m_quotaTimer;            // 扣减后延迟写入设置
+    bool m_quotaDirty = false;
+};
+
+#endif // REQUESTSCHEDULER_H
@@ -0,0 +1,27 @@
+#ifndef SENTENCESEGMENTER_H
+#define SENTENCESEGMENTER_H
+
+#include <QString>
+#include <QStringList>
+
+// 按句子切分文本：segments[i] 之后紧跟 separators[i]，leading 为开头的空白
+// 句段不含换行，换行与句间空白都保存在分隔符中，拼接时原样还原
+class SentenceSegmenter {
+public:
+    struct Segmented {
+        QString leading;
+        QStringList segments;
+        QStringList separators;
+    };
+
+    static Segmented split(const QString &text);
+    // 用译文替换各句段后拼接，译文以中日韩标点结尾时去掉句间空格
+    static QString join(const Segmented &segmented, const QStringList &translations);
+    // 句段中是否有需要翻译的文字（不只是占位符、数字和标点）
+    static bool needsTranslation(const QString &segment);
+
+private:
+    static bool isSentenceEnd(const QString &text, int pos);
+};
+
+#endif // SENTENCESEGMENTER_H
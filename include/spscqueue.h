@@ -0,0 +1,60 @@
+#ifndef SPSCQUEUE_H
+#define SPSCQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// 无锁单生产者/单消费者无界队列
+// push 只能在一个线程中调用，pop 只能在另一个线程中调用
+template <typename T>
+class SpscQueue {
+public:
+    SpscQueue() {
+        Node *stub = new Node;
+        m_head = stub;
+        m_tail = stub;
+    }
+
+    ~SpscQueue() {
+        while (m_head) {
+            Node *next = m_head->next.load(std::memory_order_relaxed);
+            delete m_head;
+            m_head = next;
+        }
+    }
+
+    SpscQueue(const SpscQueue &) = delete;
+    SpscQueue &operator=(const SpscQueue &) = delete;
+
+    // 生产者线程
+    void push(T value) {
+        Node *node = new Node;
+        node->value = std::move(value);
+        m_tail->next.store(node, std::memory_order_release);
+        m_tail = node;
+    }
+
+    // 消费者线程
+    bool pop(T &value) {
+        Node *next = m_head->next.load(std::memory_order_acquire);
+        if (!next) {
+            return false;
+        }
+        value = std::move(next->value);
+        delete m_head;
+        m_head = next;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node *> next{nullptr};
+        T value;
+    };
+
+    // 头尾分属不同线程，分开放在不同缓存行避免伪共享
+    alignas(64) Node *m_head;
+    alignas(64) Node *m_tail;
+};
+
+#endif // SPSCQUEUE_H
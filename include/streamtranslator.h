@@ -0,0 +1,77 @@
+#ifndef STREAMTRANSLATOR_H
+#define STREAMTRANSLATOR_H
+
+#include <QObject>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QSaveFile>
+#include <QXmlStreamReader>
+#include <QXmlStreamWriter>
+#include "tsfilehandler.h"
+
+class TranslationService;
+
+// 流式翻译超大 .ts 文件：边读边把未完成的消息按窗口交给批量翻译，结果返回后按原顺序写出。
+// 内存中只保留当前窗口内的消息，不建立完整的条目列表
+class StreamTranslator : public QObject {
+    Q_OBJECT
+public:
+    explicit StreamTranslator(TranslationService *service, QObject *parent = nullptr);
+
+    // 每个窗口最多等待翻译的消息数，窗口写出后才继续读取
+    void setWindowSize(int messages);
+    int windowSize() const { return m_windowSize; }
+
+    // outputPath 可以与 inputPath 相同，全部写完后才替换原文件
+    bool start(const QString &inputPath, const QString &outputPath);
+    void cancel();
+    bool isRunning() const { return m_running; }
+
+signals:
+    // messages 为已读取的消息总数
+    void progress(int translated, int failed, int messages);
+    void finished(bool success, const QString &errorMessage);
+
+private:
+    // 窗口中的一项：消息或上下文边界，按读取顺序写出
+    struct Item {
+        enum Kind { ContextStart, ContextEnd, Message };
+        Kind kind;
+        TsEntry entry;              // ContextStart 只使用 entry.context
+        bool pending = false;       // 正在等待译文
+    };
+
+    void nextWindow();
+    void fillWindow();
+    void readContextName();
+    void push(Item &&item);
+    void flush();
+    void writeItem(const Item &item);
+    void applyResult(const QString &source, const QString &translation, TranslationState state);
+    void onBatchCompleted();
+    void onError(const QString &errorMessage);
+    void finish(bool success, const QString &errorMessage = QString());
+
+    TranslationService *m_service;
+    int m_windowSize = 256;
+    bool m_running = false;
+
+    QFile m_input;
+    QSaveFile m_output;
+    QXmlStreamReader m_reader;
+    QXmlStreamWriter m_writer;
+    QString m_currentContext;
+
+    QList<Item> m_window;
+    qint64 m_windowBase = 0;                    // m_window 第一项的序号
+    QHash<QString, QList<qint64>> m_waiting;    // 源文本 -> 等待该译文的消息序号
+    bool m_batchRunning = false;
+    QString m_lastError;
+
+    int m_messages = 0;
+    int m_translated = 0;
+    int m_failed = 0;
+};
+
+#endif // STREAMTRANSLATOR_H
@@ -0,0 +1,85 @@
+#ifndef TRACERECORDER_H
+#define TRACERECORDER_H
+
+#include <QString>
+#include <QVector>
+#include <QMutex>
+#include <atomic>
+
+// Chrome trace-event 格式的跨度记录器，结果可在 Perfetto / chrome://tracing 中打开
+// 关闭时每个跨度只有一次原子读，几乎没有开销
+class TraceRecorder {
+public:
+    static TraceRecorder &instance();
+    static qint64 nowUs();
+
+    bool isEnabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+    void start();
+    bool stop(const QString &filePath);
+
+    // 通过环境变量 QTTS_TRACE_FILE 启用，退出时写入该文件
+    void startFromEnvironment();
+    QString environmentOutputPath() const { return m_environmentPath; }
+
+    void completeEvent(const char *name, const char *category,
+                       qint64 startUs, qint64 durationUs, const QString &detail = QString());
+    void asyncBegin(const char *name, const char *category, quint64 id,
+                    const QString &detail = QString());
+    void asyncEnd(const char *name, const char *category, quint64 id,
+                  const QString &detail = QString());
+
+    quint64 nextAsyncId() { return m_nextAsyncId.fetch_add(1, std::memory_order_relaxed); }
+
+private:
+    TraceRecorder() = default;
+
+    struct Event {
+        const char *name;
+        const char *category;
+        char phase;
+        qint64 timestampUs;
+        qint64 durationUs;
+        quint64 id;
+        quintptr threadId;
+        QString detail;
+    };
+
+    void append(Event &&event);
+
+    std::atomic<bool> m_enabled{false};
+    std::atomic<quint64> m_nextAsyncId{1};
+    QMutex m_mutex;
+    QVector<Event> m_events;
+    QString m_environmentPath;
+};
+
+// 作用域跨度：构造时记录开始时间，析构时写入一个完整事件
+class TraceScope {
+public:
+    explicit TraceScope(const char *name, const char *category = "app")
+        : m_name(name), m_category(category),
+          m_startUs(TraceRecorder::instance().isEnabled() ? TraceRecorder::nowUs() : -1) {}
+
+    ~TraceScope() {
+        if (m_startUs >= 0) {
+            TraceRecorder::instance().completeEvent(m_name, m_category, m_startUs,
+                                                    TraceRecorder::nowUs() - m_startUs, m_detail);
+        }
+    }
+
+    void setDetail(const QString &detail) {
+        if (m_startUs >= 0) m_detail = detail;
+    }
+
+    TraceScope(const TraceScope &) = delete;
+    TraceScope &operator=(const TraceScope &) = delete;
+
+private:
+    const char *m_name;
+    const char *m_category;
+    qint64 m_startUs;
+    QString m_detail;
+};
+
+#endif // TRACERECORDER_H
@@ -0,0 +1,31 @@
+#ifndef TRANSLATIONCACHE_H
+#define TRANSLATIONCACHE_H
+
+#include <QCache>
+#include <QString>
+
+// 句段级译文缓存（LRU），键由引擎、语言对与遮蔽后的句段组成
+class TranslationCache {
+public:
+    explicit TranslationCache(int maxEntries = 50000);
+
+    static QString key(int engine, const QString &sourceLang, const QString &targetLang, const QString &text);
+
+    bool lookup(const QString &key, QString &translation);
+    // 只判断是否存在，不计入命中统计，也不刷新 LRU 顺序
+    bool contains(const QString &key) const { return m_entries.contains(key); }
+    void insert(const QString &key, const QString &translation);
+    void remove(const QString &key);
+    void clear();
+
+    int hits() const { return m_hits; }
+    int misses() const { return m_misses; }
+    int size() const { return m_entries.size(); }
+
+private:
+    QCache<QString, QString> m_entries;
+    int m_hits = 0;
+    int m_misses = 0;
+};
+
+#endif // TRANSLATIONCACHE_H
@@ -0,0 +1,94 @@
+#ifndef TRANSLATIONMETRICS_H
+#define TRANSLATIONMETRICS_H
+
+#include <QObject>
+#include <QMap>
+#include <QVector>
+#include <QQueue>
+#include <QMutex>
+#include <QJsonObject>
+#include "translationservice.h"
+
+// 对数分桶延迟直方图（HDR风格），单位为微秒
+// 每个2的幂区间再细分16个子桶，相对误差不超过 1/16
+class LatencyHistogram {
+public:
+    void record(qint64 valueUs);
+    void reset();
+
+    qint64 count() const { return m_count; }
+    qint64 min() const { return m_count > 0 ? m_min : 0; }
+    qint64 max() const { return m_max; }
+    double mean() const;
+    qint64 percentile(double percent) const;
+
+    QJsonObject toJson() const;
+
+private:
+    static int bucketIndex(qint64 value);
+    static qint64 bucketUpperBound(int index);
+
+    QVector<qint64> m_buckets;
+    qint64 m_count = 0;
+    qint64 m_sum = 0;
+    qint64 m_min = 0;
+    qint64 m_max = 0;
+};
+
+// 翻译请求性能指标：按引擎统计各阶段耗时、进行中请求数与吞吐量
+class TranslationMetrics : public QObject {
+    Q_OBJECT
+public:
+    // 单个引擎的汇总数据，供指标面板显示
+    struct EngineSummary {
+        qint64 requests = 0;
+        qint64 errors = 0;
+        qint64 characters = 0;
+        int inFlight = 0;
+        double requestsPerSecond = 0;
+        double charactersPerSecond = 0;
+        LatencyHistogram queueWait;   // 排队等待（批量延迟）
+        LatencyHistogram network;     // 网络往返
+        LatencyHistogram parse;       // 响应解析
+        LatencyHistogram apply;       // 结果应用到条目
+    };
+
+    static TranslationMetrics *instance();
+    static qint64 nowUs();
+
+    void requestStarted(TranslationService::Engine engine);
+    void requestFinished(TranslationService::Engine engine, qint64 queueUs, qint64 networkUs,
+                         qint64 parseUs, int characters, bool success);
+    void recordApply(TranslationService::Engine engine, qint64 applyUs);
+
+    QList<TranslationService::Engine> engines() const;
+    EngineSummary summary(TranslationService::Engine engine) const;
+
+    QJsonObject toJson() const;
+    bool exportJson(const QString &filePath) const;
+    void reset();
+
+private:
+    explicit TranslationMetrics(QObject *parent = nullptr);
+
+    // 吞吐量统计窗口（秒）
+    static constexpr int RateWindowSeconds = 5;
+
+    struct RateSample {
+        qint64 atUs;
+        int characters;
+    };
+
+    struct EngineStats {
+        EngineSummary summary;
+        QQueue<RateSample> recent;
+    };
+
+    void trimRateWindow(EngineStats &stats, qint64 now) const;
+    void updateRates(EngineStats &stats, qint64 now) const;
+
+    mutable QMutex m_mutex;
+    mutable QMap<TranslationService::Engine, EngineStats> m_stats;
+};
+
+#endif // TRANSLATIONMETRICS_H
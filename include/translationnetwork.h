@@ -0,0 +1,111 @@
+#ifndef TRANSLATIONNETWORK_H
+#define TRANSLATIONNETWORK_H
+
+#include <QObject>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QNetworkRequest>
+#include <QThread>
+#include <QHash>
+#include <memory>
+#include "spscqueue.h"
+#include "translationservice.h"
+
+// 在GUI线程构建、交给网络线程发送的请求
+struct TranslationRequest {
+    quint64 id = 0;
+    TranslationService::Engine engine = TranslationService::GoogleTranslate;
+    QNetworkRequest request;
+    QByteArray body;            // 为空时使用 GET
+    bool post = false;
+    bool isBatch = false;
+    QString originalText;       // 单条请求的源文本
+    QStringList batchTexts;     // 批量请求的源文本，按顺序对应响应
+    int characters = 0;
+    qint64 queuedAtUs = 0;
+    quint64 traceId = 0;
+    // 每个句段一个键（引擎、语言对与遮蔽文本）；句段已在进行中的请求里时挂到该请求上，为空时不合并
+    QStringList flightKeys;
+};
+
+// 网络线程解析完成后投递回GUI线程的结果
+struct TranslationReply {
+    quint64 id = 0;
+    TranslationService::Engine engine = TranslationService::GoogleTranslate;
+    bool isBatch = false;
+    QString originalText;
+    QString translatedText;
+    QMap<QString, QString> batchResults;
+    QString errorMessage;       // 非空表示失败
+    int errorCode = 0;          // 引擎返回的错误代码
+    bool networkError = false;
+    bool aborted = false;       // 被 abort() 取消（对冲请求的失败方）
+    bool coalesced = false;     // 挂在其他调用方的请求上，没有单独发送
+    int httpStatus = 0;
+    int characters = 0;
+    qint64 queueUs = 0;
+    qint64 networkUs = 0;
+    qint64 parseUs = 0;
+};
+
+// 每个 TranslationService 拥有一个结果通道：网络线程写入，GUI线程读取
+struct ReplyChannel {
+    SpscQueue<TranslationReply> queue;
+    std::atomic<bool> notifyPending{false};
+};
+
+// 网络线程：持有共享的 QNetworkAccessManager，负责发送请求、读取与解析响应
+class TranslationNetwork : public QObject {
+    Q_OBJECT
+public:
+    static TranslationNetwork *instance();
+
+    // 可在任意线程调用
+    void submit(const std::shared_ptr<ReplyChannel> &channel, const TranslationRequest &request);
+    void warmUp(const QUrl &url);
+    // 取消仍在进行的请求，结果以 aborted 标记照常投递
+    void abort(quint64 requestId);
+
+signals:
+    // 某个通道由空变为非空时发出（跨线程排队投递）
+    void repliesReady();
+
+private slots:
+    void onReplyFinished(QNetworkReply *reply);
+
+private:
+    explicit TranslationNetwork(QObject *parent = nullptr);
+
+    void startRequest(const std::shared_ptr<ReplyChannel> &channel, const TranslationRequest &request);
+    void deliver(const std::shared_ptr<ReplyChannel> &channel, TranslationReply &&reply);
+
+    // 解析响应（在网络线程中执行）
+    static void parseResponse(const QByteArray &response, const TranslationRequest &request,
+                              TranslationReply &reply);
+    static QString parseGoogleResponse(const QByteArray &response);
+    static QString parseBaiduResponse(const QByteArray &response, TranslationReply &reply);
+    static QString parseDeepLResponse(const QByteArray &response);
+    static QString parseYoudaoResponse(const QByteArray &response, TranslationReply &reply);
+
+    // 等待同一个网络响应的调用方，第一个为实际发送者
+    struct Waiter {
+        std::shared_ptr<ReplyChannel> channel;
+        TranslationRequest request;
+        qint64 sentAtUs = 0;
+        bool coalesced = false;
+    };
+
+    struct PendingRequest {
+        TranslationRequest request;     // 实际发送的请求，首个等待者被取消后仍按它解析
+        QList<Waiter> waiters;
+        bool aborted = false;
+    };
+
+    static TranslationReply replyFor(const Waiter &waiter, qint64 finishedAt);
+
+    QNetworkAccessManager *m_networkManager;
+    QHash<QNetworkReply *, PendingRequest> m_pending;
+    QHash<QString, QNetworkReply *> m_inFlight;     // 句段键 -> 包含该句段的进行中响应
+};
+
+#endif // TRANSLATIONNETWORK_H
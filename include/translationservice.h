@@ -10,6 +10,18 @@
 #include <QUrlQuery>
 #include <QSettings>
 #include <QMap>
+#include <QHash>
+#include <QTimer>
+#include <QSet>
+#include <memory>
+#include "placeholdermasker.h"
+#include "sentencesegmenter.h"
+#include "translationcache.h"
+#include "phrasebook.h"
+
+struct TranslationRequest;
+struct TranslationReply;
+struct ReplyChannel;
 
 class TranslationService : public QObject {
     Q_OBJECT
@@ -25,18 +37,47 @@ public:
     bool isBatchRunning() const;
 
     explicit TranslationService(QObject *parent = nullptr);
+    ~TranslationService() override;
     void setCurrentEngine(Engine engine);
     void setApiKey(Engine engine, const QString &apiKey);
     void setLanguages(Engine engine, const QString &sourceLang, const QString &targetLang);
     void translateText(const QString &text);
-    void translateBatch(const QStringList &texts);
+    // contexts 与 texts 一一对应，用于把指定上下文固定给某个引擎；可以为空
+    void translateBatch(const QStringList &texts, const QStringList &contexts = QStringList());
 
     void translateNextInBatch();
 
     void cancelBatch();
 
+    // 预连接当前引擎的端点（DNS + TCP + TLS），在选择引擎或打开文件时调用
+    void warmUpConnection();
+
+    // 多引擎分片：批量翻译同时使用所有已配置且仍有额度的引擎，快的引擎拉取更多工作
+    void setShardingEnabled(bool enabled);
+    bool isShardingEnabled() const { return m_shardingEnabled; }
+    // 匹配通配符的上下文只交给指定引擎翻译，engine 为 -1 时不固定
+    void setPinnedEngine(int engine, const QStringList &contextPatterns);
+    int pinnedEngine() const { return m_pinnedEngine; }
+    QStringList pinnedContexts() const { return m_pinnedContexts; }
+    // 批量翻译中属于这些上下文（当前选中的上下文）的句段优先发送，批次进行中也可以调整
+    void setPriorityContexts(const QStringList &contexts);
+    // 离线短语库（.qph 或 .csv），在请求网络引擎之前查找；返回 false 时 errorMessage 说明无法读取的文件
+    bool setPhrasebooks(const QStringList &fileNames, QString *errorMessage = nullptr);
+    QStringList phrasebooks() const { return m_phrasebookFiles; }
+    int phrasebookSize() const { return m_phrasebook ? m_phrasebook->size() : 0; }
+    // 剩余字符额度，-1 表示不限；由 RequestScheduler 统一记录，所有实例共用
+    void setRemainingQuota(Engine engine, qint64 characters);
+    qint64 remainingQuota(Engine engine) const;
+
+    // 审阅预取：以低优先级把文本翻译进缓存，不发出结果信号；新的调用替换尚未发出的预取
+    void prefetch(const QStringList &texts);
+    // 本次运行中预取最多消耗的字符数，0 表示关闭预取
+    void setPrefetchBudget(qint64 characters);
+    qint64 prefetchBudget() const { return m_prefetchBudget; }
+
     static QList<Engine> supportedEngines();
     static QString engineName(Engine engine);
+    static QUrl engineEndpoint(Engine engine);
 
     Engine currentEngine() const {
         return m_currentEngine;
@@ -47,16 +88,122 @@ signals:
     void translationCompleted(const QString &original, const QString &translated);
     void singleTranslationCompleted(const QString &context, const QString &source, const QString &translation);
     void batchTranslationCompleted(const QMap<QString, QString> &results);
+    // 批量翻译中第 index 条文本（translateBatch 参数中的下标）的结果，intact 为 false 表示占位符丢失
+    void batchTextTranslated(int index, const QString &translation, bool intact);
     void errorOccurred(const QString &errorMessage, const QString &sourceText = "");
+    // 译文中丢失了占位符或标记，translation 为尽力还原后的结果，需要人工复核
+    void placeholderMismatch(const QString &source, const QString &translation, const QStringList &missingTokens);
     void batchProgress(int current, int total);
     void batchCanceled();
 private slots:
-    void onTranslationFinished(QNetworkReply *reply);
+    void drainReplies();
 
 private:
-    QNetworkAccessManager *m_networkManager;
+    std::shared_ptr<ReplyChannel> m_replyChannel;
+    quint64 m_nextRequestId = 1;
     Engine m_currentEngine;
 
+    // 批量翻译中每个引擎的工作通道
+    struct EngineLane {
+        bool busy = false;
+        bool pinnedPack = false;    // 当前包来自固定上下文，不允许被其他引擎窃取
+        bool hedged = false;        // 当前包已发出对冲请求
+        QStringList pack;
+        qint64 sentAtUs = 0;
+    };
+
+    struct BatchState {
+        QStringList batchQueue;
+        QVector<PlaceholderMasker::MaskedText> maskedQueue;   // 与 batchQueue 一一对应
+        QVector<SentenceSegmenter::Segmented> segmented;       // 每条文本的句段
+        QVector<int> pendingSegments;                          // 每条文本尚未返回的句段数
+        QVector<bool> failed;
+        QHash<QString, QList<int>> waiting;                    // 句段 -> 等待它的文本下标
+        QHash<QString, QString> segmentResults;                // 句段 -> 译文
+        QHash<QString, Engine> segmentEngines;                 // 句段 -> 给出译文的引擎
+        QHash<QString, int> inFlightCopies;                    // 句段 -> 正在进行的请求数
+        QStringList segmentQueue;                              // 去重后待发送的句段
+        int nextSegment = 0;
+        QStringList pinnedQueue;                               // 固定上下文的句段
+        int nextPinned = 0;
+        QStringList contexts;                                  // 与 batchQueue 一一对应，可以为空
+        QStringList priorityQueue;                             // segmentQueue 中属于优先上下文的句段
+        int nextPriority = 0;
+        QMap<Engine, EngineLane> lanes;
+        QList<Engine> unhealthyEngines;                        // 本批次中出现账户级错误的引擎
+        QMap<QString, QString> batchResults;
+        int completedTexts = 0;
+        int batchTotal = 0;
+    };
+    BatchState m_batchState;
+
+    static QNetworkRequest createRequest(const QUrl &url);
+    void dispatch(TranslationRequest &request);
+    void onTranslationFinished(const TranslationReply &reply);
+    void translateMasked(const PlaceholderMasker::MaskedText &masked);
+    void translateWithEngine(Engine engine, const QString &text);
+    void sendNextPrefetch();
+    void sendPrefetch(Engine engine, const PlaceholderMasker::MaskedText &masked, const QString &key);
+    // 还原译文；占位符完整时返回 true，否则发出 placeholderMismatch
+    bool restoreTranslation(const PlaceholderMasker::MaskedText &masked, const QString &translated,
+                            QString &result);
+    bool deliverResult(const PlaceholderMasker::MaskedText &masked, const QString &translated, int batchIndex = -1);
+
+    // 批量翻译按句段进行：请求ID -> 该请求包含的句段
+    struct SegmentRequest {
+        quint64 generation;
+        QStringList segments;
+        bool hedge;
+    };
+    QList<Engine> batchEngines() const;
+    bool isPinnedContext(const QString &context) const;
+    bool lookupCached(const QList<Engine> &engines, const QString &segment, QString &translation);
+    bool lookupPhrasebook(const QString &masked, QString &translation) const;
+    static void packLimits(Engine engine, int &maxSegments, int &maxCharacters);
+    void rebuildPriorityQueue();
+    QStringList takePack(Engine engine, bool &pinned, bool &priority);
+    void scheduleLane(Engine engine, const QStringList &pack, bool pinned, bool priority);
+    void sendSegmentPack(Engine engine, const QStringList &pack, bool hedge = false);
+    void onSegmentsFinished(const TranslationReply &reply, const SegmentRequest &request);
+    void releaseSegment(const QString &segment, bool success);
+    void requeueSegment(const QString &segment);
+    void resolveSegment(const QString &segment, bool success);
+    void completeBatchText(int index);
+    static bool isFatalEngineError(const TranslationReply &reply);
+    void markEngineUnhealthy(Engine engine, const QString &reason);
+    static qint64 hedgeThresholdUs(Engine engine);
+    void hedgeSlowRequests();
+    void abortSettledRequests();
+    QString cacheKey(Engine engine, const QString &text) const;
+
+    TranslationCache m_cache;
+    std::shared_ptr<const Phrasebook> m_phrasebook;
+    QStringList m_phrasebookFiles;
+    QStringList m_pendingSegments;
+    QHash<quint64, SegmentRequest> m_segmentRequests;
+    quint64 m_batchGeneration = 0;
+    QTimer *m_hedgeTimer;
+    bool m_pendingHedge = false;
+    QSet<quint64> m_abortedRequests;
+
+    bool m_shardingEnabled = false;
+    int m_pinnedEngine = -1;
+    QStringList m_pinnedContexts;
+    QSet<QString> m_priorityContexts;
+
+    // 预取：待发送的文本、进行中的请求ID与缓存键，以及在调度器中排队的缓存键
+    QVector<PlaceholderMasker::MaskedText> m_prefetchQueue;
+    QSet<quint64> m_prefetchRequests;
+    QSet<QString> m_prefetchKeys;
+    QSet<QString> m_scheduledPrefetch;
+    bool m_pendingPrefetch = false;
+    qint64 m_prefetchBudget = 20000;
+    qint64 m_prefetchSpent = 0;
+
+    // 下一次 dispatch 的请求所对应的遮蔽信息，按请求ID保存直到结果返回
+    QVector<PlaceholderMasker::MaskedText> m_pendingMasks;
+    QHash<quint64, QVector<PlaceholderMasker::MaskedText>> m_requestMasks;
+
     struct EngineConfig {
         QString apiKey;
         QString sourceLang;
@@ -65,6 +212,9 @@ private:
 
     QMap<Engine, EngineConfig> m_engineConfigs;
 
+    // 批量队列中下一个请求的入队时间，用于统计排队耗时
+    qint64 m_nextQueuedAtUs = -1;
+
     // 翻译方法
     void translateWithGoogle(const QString &text);
     void translateWithBaidu(const QString &text);
@@ -76,12 +226,6 @@ private:
     void batchTranslateWithDeepL(const QStringList &texts);
     void batchTranslateWithYoudao(const QStringList &texts);
 
-    // 解析响应
-    QString parseGoogleResponse(const QByteArray &response);
-    QString parseBaiduResponse(const QByteArray &response);
-    QString parseDeepLResponse(const QByteArray &response);
-    QString parseYoudaoResponse(const QByteArray &response);
-
     // 语言代码转换
     QString toGoogleLanguageCode(const QString &lang);
     QString toBaiduLanguageCode(const QString &lang);
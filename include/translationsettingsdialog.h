@@ -6,6 +6,8 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QTabWidget>
+#include <QCheckBox>
+#include <QSpinBox>
 #include "translationservice.h"
 
 class TranslationSettingsDialog : public QDialog {
@@ -17,15 +19,32 @@ public:
     QString apiKey(TranslationService::Engine engine) const;
     QString sourceLanguage(TranslationService::Engine engine) const;
     QString targetLanguage(TranslationService::Engine engine) const;
+    qint64 remainingQuota(TranslationService::Engine engine) const;
+
+    bool shardingEnabled() const;
+    int pinnedEngine() const;
+    QStringList pinnedContexts() const;
+
+    int prefetchCount() const;
+    qint64 prefetchBudget() const;
+
+    QStringList phrasebooks() const;
 
 private:
     QTabWidget *m_tabWidget;
     QComboBox *m_engineCombo;
+    QCheckBox *m_shardingCheck;
+    QComboBox *m_pinnedEngineCombo;
+    QLineEdit *m_pinnedContextsEdit;
+    QSpinBox *m_prefetchCountSpin;
+    QSpinBox *m_prefetchBudgetSpin;
+    QLineEdit *m_phrasebooksEdit;
 
     struct EngineSettings {
         QLineEdit *apiKeyEdit;
         QComboBox *sourceLangCombo;
         QComboBox *targetLangCombo;
+        QSpinBox *quotaSpin;
     };
 
     QMap<TranslationService::Engine, EngineSettings> m_engineSettings;
@@ -24,6 +24,8 @@ public:
     void clear();
     QString currentTranslation() const;
     QString currentState() const;
+    // 自动翻译按钮使用的服务，预取写入它的缓存后点击即可直接返回
+    TranslationService *translationService() const { return m_translationService; }
 
 signals:
     void translationChanged(const QString &context, const QString &source,
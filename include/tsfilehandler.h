@@ -6,24 +6,12 @@
 #include <QXmlStreamWriter>
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include "entrybitmap.h"
+#include "entrystore.h"
 
-// TS文件条目状态枚举
-enum class TranslationState {
-    Unfinished,  // 未完成
-    Finished,    // 已完成
-    Vanished,    // 已消失
-    Obsolete     // 已废弃
-};
-
-// TS文件条目结构
-struct TsEntry {
-    QString source;             // 源文本
-    QString translation;        // 翻译文本
-    TranslationState state;      // 翻译状态
-    QStringList comments;       // 注释
-    QStringList locations;      // 位置信息 (filename:line)
-    QString context;            // 上下文信息
-};
+class QFileSystemWatcher;
+class QTimer;
 
 // TS文件处理类
 class TsFileHandler : public QObject {
@@ -32,13 +20,32 @@ class TsFileHandler : public QObject {
 public:
     explicit TsFileHandler(QObject *parent = nullptr);
     bool load(const QString &filePath);
-    bool save(const QString &filePath);
-    const QList<TsEntry> &entries() const { return m_entries; }
+    // updateSnapshot 为 false 时（批量翻译的自动保存）只写TS文件，快照留到 flushSnapshot()
+    bool save(const QString &filePath, bool updateSnapshot = true);
+    // 只有正在编辑的文件维护 .snapshot 旁路文件；只读打开（合并来源、批量发布）时保持关闭
+    void setSnapshotsEnabled(bool enabled) { m_snapshotsEnabled = enabled; }
+    // 关闭文件或退出前调用：自动保存后尚未更新的快照在内容与磁盘一致时补写
+    void flushSnapshot();
+    // 直接由当前条目生成 .qm 文件，等同于对已保存的文件运行 lrelease
+    bool release(const QString &qmPath) const;
+    // 只能在 GUI 线程读取；后台线程使用 snapshot()
+    const EntryStore &entries() const { return m_entries; }
+    EntryStore::Snapshot snapshot() const { return m_entries.snapshot(); }
     TsEntry entryAt(int index) const;
     void updateEntryTranslation(int index, const QString &translation);
     void updateEntryState(int index, TranslationState state);
+    // 批量写入译文与状态：一次发布新版本，只发出一个 entriesUpdated
+    struct TranslationUpdate {
+        int index;
+        QString translation;
+        TranslationState state;
+    };
+    void applyTranslations(QVector<TranslationUpdate> &&updates);
     void addEntry(const TsEntry &entry);
-    void removeEntry(int index);
+    // 一次删除多个条目：压缩存储与位图后只发出一个 entriesRemoved
+    void removeEntries(QVector<int> indices);
+    // 删除 removed（升序）中的条目后，原下标 index 的新下标；index 本身被删除时返回 -1
+    static int remapIndex(const QVector<int> &removed, int index);
     QString language() const { return m_language; }
     QString version() const { return m_version; }
     QString sourceLanguage() const { return m_sourceLanguage; }
@@ -68,26 +75,90 @@ public:
 
     Statistics getStatistics() const;
 
+    // 从旧文件合并译文：当前条目视为新提取的结果
+    struct MergeConflict {
+        int index;                  // 当前文件中的条目
+        QString context;
+        QString source;
+        QStringList candidates;     // 互相矛盾的旧译文
+    };
+    struct MergeReport {
+        int exactMatches = 0;       // 按 (上下文, 源文本) 匹配
+        int sourceMatches = 0;      // 仅按源文本匹配，标记为未完成待复核
+        int untranslated = 0;       // 没有可用的旧译文
+        int vanished = 0;           // 旧文件中有译文但已不再出现的消息，以 vanished 追加
+        int obsolete = 0;           // 旧文件中本就废弃的消息，以 obsolete 追加
+        QList<MergeConflict> conflicts;
+    };
+    // 先按 (上下文, 源文本) 再按源文本做哈希连接，整体为线性时间
+    MergeReport mergeTranslations(const EntryStore &previous);
+
+    // 状态位图索引：随每次状态或译文修改同步更新，查询无需扫描全部条目
+    const EntryBitmap &stateBitmap(TranslationState state) const;
+    const EntryBitmap &emptyTranslationBitmap() const { return m_emptyTranslationBits; }
+    EntryBitmap untranslatedBitmap() const;     // 未完成 ∪ 译文为空
+    EntryBitmap needsReviewBitmap() const;      // 未完成 − 译文为空
+
+    // 审阅导航：返回 index 之后/之前第一个属于集合的条目，wrap 时回绕，没有则返回 -1
+    static int nextEntry(const EntryBitmap &set, int index, bool wrap = true);
+    static int previousEntry(const EntryBitmap &set, int index, bool wrap = true);
+
+    // 监视已打开的文件：外部修改（如 lupdate 重新生成）后只重新解析内容变化的上下文并合并，
+    // 未保存的本地修改保留译文与状态
+    void setWatching(bool enabled);
+    bool isModified(int index) const { return m_dirtyBits.test(index); }
+
+    // TS 格式的消息读写，与 StreamTranslator 共用，保证两处写出的格式一致
+    static QString stateToString(TranslationState state);
+    static TranslationState stringToState(const QString &stateStr);
+    // 当前记号为 <message> 开始元素，读到对应的结束元素为止
+    static void readMessage(QXmlStreamReader &reader, TsEntry &entry);
+    static void writeMessage(QXmlStreamWriter &writer, const TsEntry &entry);
+
 signals:
     void fileLoaded(bool success);
     void fileSaved(bool success);
     void entryUpdated(int index);
+    // [first, last] 范围内有条目被 applyTranslations 修改
+    void entriesUpdated(int first, int last);
     void entryAdded(int index);
-    void entryRemoved(int index);
+    // indices 为升序的原下标，发出时条目已删除
+    void entriesRemoved(const QVector<int> &indices);
+    void externalChangesMerged(int updated, int added, int removed);
+    void entriesReset();
 
 private:
-    QList<TsEntry> m_entries;      // 所有条目
+    EntryStore m_entries;          // 所有条目
     QString m_filePath;            // 文件路径
     QString m_language;            // 目标语言
     QString m_version;             // TS文件版本
     QString m_sourceLanguage;      // 源语言
 
-    void parseXml(QXmlStreamReader &reader);
+    void parseXml(QXmlStreamReader &reader, QList<TsEntry> &entries);
     void generateXml(QXmlStreamWriter &writer);
-    QString stateToString(TranslationState state) const;
-    TranslationState stringToState(const QString &stateStr) const;
 
+    void rebuildIndexes();
+    // 为刚读取或写入的内容（哈希为 m_savedHash）生成二进制快照，下次打开同一文件时跳过XML解析
+    void writeSnapshot();
+
+    void watchCurrentFile();
+    void reloadChangedContexts();
+    void mergeContext(const QList<int> &current, const QList<TsEntry> &incoming,
+                      int &updated, int &added, QList<int> &removed);
+    void replaceEntry(int index, const TsEntry &entry);
+    void setIndexedState(int index, TranslationState oldState, TranslationState newState);
+
+    EntryBitmap m_stateBits[4];             // 按 TranslationState 取下标
+    EntryBitmap m_emptyTranslationBits;     // 译文为空的条目
+    EntryBitmap m_dirtyBits;                // 上次加载或保存后被修改过的条目
+
+    QFileSystemWatcher *m_watcher = nullptr;
+    QTimer *m_reloadTimer = nullptr;
+    QHash<QString, QByteArray> m_contextHashes;   // 上下文名 -> 该上下文在文件中的原始字节哈希
 
+    bool m_snapshotsEnabled = false;
+    bool m_snapshotStale = false;                 // 自动保存后快照未更新
+    QByteArray m_savedHash;                       // 最近一次读取或写入的文件内容哈希
 };
 
 #endif
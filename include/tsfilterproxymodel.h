@@ -0,0 +1,42 @@
+#ifndef TSFILTERPROXYMODEL_H
+#define TSFILTERPROXYMODEL_H
+
+#include <QSortFilterProxyModel>
+#include "tstreemodel.h"
+
+// 树模型的筛选/排序代理：按状态、上下文名称筛选，可按源文本长度排序
+// 上下文行使用模型预先统计的计数判断，切换筛选不需要重新解析或重建
+class TsFilterProxyModel : public QSortFilterProxyModel {
+    Q_OBJECT
+public:
+    enum SortMode {
+        FileOrder,
+        SourceLength
+    };
+
+    explicit TsFilterProxyModel(QObject *parent = nullptr);
+
+    void setStateFilter(TsTreeModel::Filter filter);
+    TsTreeModel::Filter stateFilter() const { return m_stateFilter; }
+
+    void setContextFilter(const QString &pattern);
+    QString contextFilter() const { return m_contextFilter; }
+
+    void setSortMode(SortMode mode);
+    SortMode sortMode() const { return m_sortMode; }
+
+    void fetchMore(const QModelIndex &parent) override;
+
+protected:
+    bool filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const override;
+    bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+
+private:
+    TsTreeModel *treeModel() const;
+
+    TsTreeModel::Filter m_stateFilter = TsTreeModel::AllEntries;
+    QString m_contextFilter;
+    SortMode m_sortMode = FileOrder;
+};
+
+#endif // TSFILTERPROXYMODEL_H
@@ -0,0 +1,30 @@
+#ifndef TSSNAPSHOT_H
+#define TSSNAPSHOT_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include "tsfilehandler.h"
+
+// TS文件的二进制快照，保存在同目录的 <文件名>.snapshot 中
+// 格式：固定头 + 字符串偏移表 + 定长条目记录 + 列表表 + UTF-16 字符区，全部小端
+// 所有字符串去重后只存一份，打开时映射文件并按偏移直接读取，无需解析XML
+class TsSnapshot {
+public:
+    struct Catalog {
+        QString version;
+        QString language;
+        QString sourceLanguage;
+        QList<TsEntry> entries;
+    };
+
+    static QString snapshotPath(const QString &tsPath);
+    static QByteArray contentHash(const QByteArray &content);
+
+    // 快照与TS文件大小、修改时间一致时直接使用；只有修改时间不同时比较内容哈希
+    static bool load(const QString &tsPath, Catalog &catalog);
+    // contentHash 为写入快照时TS文件内容的哈希；写入失败（如目录只读）时返回 false
+    static bool save(const QString &tsPath, const QByteArray &contentHash, const Catalog &catalog);
+};
+
+#endif // TSSNAPSHOT_H
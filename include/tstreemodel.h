@@ -0,0 +1,89 @@
+#ifndef TSTREEMODEL_H
+#define TSTREEMODEL_H
+
+#include <QAbstractItemModel>
+#include <QVector>
+#include <QHash>
+#include "tsfilehandler.h"
+
+// 基于 TsFileHandler 的两级树模型：上下文节点在重置时一次建立，
+// 消息行通过 canFetchMore/fetchMore 按需分批加入，显示数据直接从条目计算
+class TsTreeModel : public QAbstractItemModel {
+    Q_OBJECT
+public:
+    enum Roles {
+        EntryIndexRole = Qt::UserRole + 1,  // 消息行对应的条目下标
+        StateRole,                          // 消息行的 TranslationState
+        SourceLengthRole                    // 消息行源文本长度
+    };
+
+    // 状态筛选条件
+    enum Filter {
+        AllEntries,
+        UnfinishedEntries,      // 未完成或译文为空
+        NeedsReviewEntries,     // 未完成但已有译文
+        ObsoleteEntries         // 已废弃或已消失
+    };
+
+    static bool entryMatches(const TsEntry &entry, Filter filter);
+
+    explicit TsTreeModel(TsFileHandler *fileHandler, QObject *parent = nullptr);
+
+    QModelIndex index(int row, int column, const QModelIndex &parent = QModelIndex()) const override;
+    QModelIndex parent(const QModelIndex &child) const override;
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    int columnCount(const QModelIndex &parent = QModelIndex()) const override;
+    bool hasChildren(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+    QVariant headerData(int section, Qt::Orientation orientation, int role = Qt::DisplayRole) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+
+    bool canFetchMore(const QModelIndex &parent) const override;
+    void fetchMore(const QModelIndex &parent) override;
+
+    bool isContext(const QModelIndex &index) const;
+    QString contextName(const QModelIndex &index) const;
+    int entryIndex(const QModelIndex &index) const;
+    const TsEntry &entryAt(int entryIndex) const { return m_fileHandler->entries().at(entryIndex); }
+
+    // 返回条目对应的消息行（必要时先加载到该行）
+    QModelIndex indexForEntry(int entryIndex);
+
+    // 上下文中符合筛选条件的消息数（预先统计，O(1)）
+    int contextMatchCount(int contextRow, Filter filter) const;
+
+public slots:
+    void rebuild();
+
+private slots:
+    void onEntryUpdated(int entryIndex);
+    void onEntriesUpdated(int first, int last);
+    void onEntryAdded(int entryIndex);
+    void onEntriesRemoved(const QVector<int> &indices);
+
+private:
+    // 每次 fetchMore 加载的消息行数
+    static constexpr int FetchChunkSize = 256;
+
+    struct ContextNode {
+        QString name;
+        QVector<int> entries;   // 该上下文中的条目下标
+        int fetched = 0;        // 已加载到视图中的消息行数
+        int finished = 0;
+        int unfinished = 0;
+        int needsReview = 0;
+        int obsolete = 0;
+    };
+
+    void countContext(ContextNode &node) const;
+
+    QString stateToString(TranslationState state) const;
+
+    TsFileHandler *m_fileHandler;
+    QVector<ContextNode> m_contexts;
+    QHash<QString, int> m_contextRows;  // 上下文名 -> 上下文行
+    QVector<int> m_entryContext;    // 条目 -> 上下文行
+    QVector<int> m_entryRow;        // 条目 -> 上下文中的行号
+};
+
+#endif // TSTREEMODEL_H
@@ -1,33 +1,43 @@
 #ifndef TSTREEWIDGET_H
 #define TSTREEWIDGET_H
 
-#include <QTreeWidget>
-#include <QXmlStreamReader>
+#include <QTreeView>
 #include "tsfilehandler.h"
+#include "tstreemodel.h"
+#include "tsfilterproxymodel.h"
 
-class TsTreeWidget : public QTreeWidget {
+class TsTreeWidget : public QTreeView {
     Q_OBJECT
 public:
     explicit TsTreeWidget(QWidget *parent = nullptr);
 
-    bool loadTsFile(const QString &filePath);
+    void setFileHandler(TsFileHandler *fileHandler);
+    TsTreeModel *treeModel() const { return m_model; }
+
+    void setStateFilter(TsTreeModel::Filter filter);
+    void setContextFilter(const QString &pattern);
+    void setSortMode(TsFilterProxyModel::SortMode mode);
+
     QString selectedContext() const;
     QString selectedSource() const;
 
+    // 当前选中消息对应的条目下标，未选中消息时返回 -1
+    int currentEntry() const;
+    // 选中并滚动到指定条目；条目被筛选隐藏时返回 false
+    bool selectEntry(int entryIndex);
+
     signals:
         void contextSelected(const QString &contextName);
     void messageSelected(const QString &contextName, const QString &source);
 
 private slots:
-    void onItemSelectionChanged();
+    void onCurrentChanged(const QModelIndex &current, const QModelIndex &previous);
 
 private:
-    void parseContext(QXmlStreamReader &reader);
-    TranslationState parseMessage(QXmlStreamReader &reader, QTreeWidgetItem *contextItem);
-    void calculateContextProgress(QTreeWidgetItem *contextItem);
-    QString stateToString(TranslationState state) const;
+    QModelIndex sourceIndex(const QModelIndex &viewIndex) const;
 
-    QString m_currentFilePath;
+    TsTreeModel *m_model = nullptr;
+    TsFilterProxyModel *m_proxy = nullptr;
 };
 
-#endif // TSTREEWIDGET_H
\ No newline at end of file
+#endif // TSTREEWIDGET_H
@@ -0,0 +1,164 @@
+#include "entrybitmap.h"
+
+#include <QtAlgorithms>
+
+EntryBitmap::EntryBitmap(int size) {
+    resize(size);
+}
+
+void EntryBitmap::resize(int size) {
+    m_size = qMax(0, size);
+    m_words.resize(wordCount(m_size));
+    clearPadding();
+}
+
+void EntryBitmap::clear() {
+    m_words.fill(0);
+}
+
+void EntryBitmap::clearPadding() {
+    // 保证最后一个字中超出 size 的位为0，计数与查询无需额外判断
+    int tail = m_size % 64;
+    if (tail != 0 && !m_words.isEmpty()) {
+        m_words.last() &= (quint64(1) << tail) - 1;
+    }
+}
+
+bool EntryBitmap::test(int index) const {
+    if (index < 0 || index >= m_size) return false;
+    return (m_words.at(index / 64) >> (index % 64)) & 1;
+}
+
+void EntryBitmap::set(int index, bool value) {
+    if (index < 0 || index >= m_size) return;
+    quint64 mask = quint64(1) << (index % 64);
+    if (value) {
+        m_words[index / 64] |= mask;
+    } else {
+        m_words[index / 64] &= ~mask;
+    }
+}
+
+void EntryBitmap::append(bool value) {
+    resize(m_size + 1);
+    set(m_size - 1, value);
+}
+
+void EntryBitmap::removeAt(int index) {
+    if (index < 0 || index >= m_size) return;
+
+    int word = index / 64;
+    int bit = index % 64;
+
+    // 当前字：保留低位，高位右移一位
+    quint64 current = m_words.at(word);
+    quint64 lowMask = (quint64(1) << bit) - 1;
+    quint64 high = bit == 63 ? 0 : (current >> (bit + 1)) << bit;
+    m_words[word] = (current & lowMask) | high;
+
+    // 后续字整体右移一位，并把下一个字的最低位移入当前字的最高位
+    for (int i = word; i < m_words.size() - 1; ++i) {
+        m_words[i] |= (m_words.at(i + 1) & 1) << 63;
+        m_words[i + 1] >>= 1;
+    }
+
+    resize(m_size - 1);
+}
+
+void EntryBitmap::removeIndices(const QVector<int> &indices) {
+    if (indices.isEmpty()) return;
+
+    // 写位置不超过读位置，原地从第一个被删位置开始前移
+    int write = indices.first();
+    int next = 0;
+    for (int read = write; read < m_size; ++read) {
+        if (next < indices.size() && indices.at(next) == read) {
+            ++next;
+            continue;
+        }
+        set(write++, test(read));
+    }
+    resize(qMin(write, m_size));
+}
+
+int EntryBitmap::count() const {
+    int total = 0;
+    for (quint64 word : m_words) {
+        total += qPopulationCount(word);
+    }
+    return total;
+}
+
+bool EntryBitmap::isEmpty() const {
+    for (quint64 word : m_words) {
+        if (word != 0) return false;
+    }
+    return true;
+}
+
+int EntryBitmap::nextSetBit(int from) const {
+    if (from < 0) from = 0;
+    if (from >= m_size) return -1;
+
+    int word = from / 64;
+    quint64 bits = m_words.at(word) & (~quint64(0) << (from % 64));
+    while (true) {
+        if (bits != 0) {
+            int index = word * 64 + static_cast<int>(qCountTrailingZeroBits(bits));
+            return index < m_size ? index : -1;
+        }
+        if (++word >= m_words.size()) return -1;
+        bits = m_words.at(word);
+    }
+}
+
+int EntryBitmap::previousSetBit(int from) const {
+    if (from >= m_size) from = m_size - 1;
+    if (from < 0) return -1;
+
+    int word = from / 64;
+    int bit = from % 64;
+    quint64 mask = bit == 63 ? ~quint64(0) : (quint64(1) << (bit + 1)) - 1;
+    quint64 bits = m_words.at(word) & mask;
+    while (true) {
+        if (bits != 0) {
+            return word * 64 + 63 - static_cast<int>(qCountLeadingZeroBits(bits));
+        }
+        if (--word < 0) return -1;
+        bits = m_words.at(word);
+    }
+}
+
+QList<int> EntryBitmap::toList() const {
+    QList<int> result;
+    result.reserve(count());
+    for (int i = nextSetBit(0); i >= 0; i = nextSetBit(i + 1)) {
+        result.append(i);
+    }
+    return result;
+}
+
+EntryBitmap &EntryBitmap::operator&=(const EntryBitmap &other) {
+    for (int i = 0; i < m_words.size(); ++i) {
+        m_words[i] &= i < other.m_words.size() ? other.m_words.at(i) : 0;
+    }
+    return *this;
+}
+
+EntryBitmap &EntryBitmap::operator|=(const EntryBitmap &other) {
+    if (other.m_size > m_size) {
+        resize(other.m_size);
+    }
+    for (int i = 0; i < other.m_words.size(); ++i) {
+        m_words[i] |= other.m_words.at(i);
+    }
+    return *this;
+}
+
+EntryBitmap &EntryBitmap::subtract(const EntryBitmap &other) {
+    int words = qMin(m_words.size(), other.m_words.size());
+    for (int i = 0; i < words; ++i) {
+        m_words[i] &= ~other.m_words.at(i);
+    }
+    return *this;
+}
@@ -0,0 +1,140 @@
+#include "entrystore.h"
+
+#include <utility>
+
+QList<TsEntry> EntryStore::Snapshot::toList() const {
+    QList<TsEntry> result;
+    result.reserve(size());
+    for (const TsEntry &entry : *this) {
+        result.append(entry);
+    }
+    return result;
+}
+
+EntryStore::EntryStore() : m_current(std::make_shared<Version>()) {}
+
+QList<TsEntry> EntryStore::toList() const {
+    QList<TsEntry> result;
+    result.reserve(size());
+    for (const TsEntry &entry : *this) {
+        result.append(entry);
+    }
+    return result;
+}
+
+EntryStore::Snapshot EntryStore::snapshot() const {
+    QMutexLocker locker(&m_mutex);
+    return Snapshot(m_current);
+}
+
+void EntryStore::assign(const QList<TsEntry> &entries) {
+    auto version = std::make_shared<Version>();
+    version->chunks.reserve((entries.size() + ChunkMask) >> ChunkShift);
+    for (int begin = 0; begin < entries.size(); begin += ChunkSize) {
+        const int end = qMin(entries.size(), begin + ChunkSize);
+        auto chunk = std::make_shared<Chunk>();
+        chunk->reserve(end - begin);
+        for (int i = begin; i < end; ++i) {
+            chunk->append(entries.at(i));
+        }
+        version->chunks.append(chunk);
+    }
+    version->size = entries.size();
+
+    QMutexLocker locker(&m_mutex);
+    version->number = m_current->number + 1;
+    m_current = version;
+}
+
+void EntryStore::clear() {
+    assign(QList<TsEntry>());
+}
+
+void EntryStore::append(const TsEntry &entry) {
+    QMutexLocker locker(&m_mutex);
+    Version &version = detachVersion();
+    if ((version.size & ChunkMask) == 0) {
+        auto chunk = std::make_shared<Chunk>();
+        chunk->reserve(ChunkSize);
+        version.chunks.append(chunk);
+    }
+    detachChunk(version.chunks.size() - 1).append(entry);
+    ++version.size;
+}
+
+void EntryStore::removeAt(int index) {
+    QMutexLocker locker(&m_mutex);
+    Version &version = detachVersion();
+    const int first = index >> ChunkShift;
+    detachChunk(first).removeAt(index & ChunkMask);
+    // 其后各块依次前移一条，保持除最后一块外都是满块
+    for (int next = first + 1; next < version.chunks.size(); ++next) {
+        Chunk &source = detachChunk(next);
+        detachChunk(next - 1).append(source.first());
+        source.removeFirst();
+    }
+    if (version.chunks.last()->isEmpty()) {
+        version.chunks.removeLast();
+    }
+    --version.size;
+}
+
+void EntryStore::removeMany(const QVector<int> &indices) {
+    if (indices.isEmpty()) {
+        return;
+    }
+    QMutexLocker locker(&m_mutex);
+    Version &version = detachVersion();
+    // 第一个被删条目之前的块保持不变（可能仍与快照共享），其后的条目依次压缩进新块
+    const int firstChunk = indices.first() >> ChunkShift;
+    const QVector<std::shared_ptr<Chunk>> tail = version.chunks.mid(firstChunk);
+    version.chunks.resize(firstChunk);
+
+    int index = firstChunk << ChunkShift;
+    int next = 0;
+    std::shared_ptr<Chunk> target;
+    for (const std::shared_ptr<Chunk> &chunk : tail) {
+        for (const TsEntry &entry : std::as_const(*chunk)) {
+            if (next < indices.size() && indices.at(next) == index++) {
+                ++next;
+                continue;
+            }
+            if (!target || target->size() == ChunkSize) {
+                target = std::make_shared<Chunk>();
+                target->reserve(ChunkSize);
+                version.chunks.append(target);
+            }
+            target->append(entry);
+        }
+    }
+    version.size -= next;
+}
+
+void EntryStore::replace(int index, const TsEntry &entry) {
+    update(index, [&entry](TsEntry &target) {
+        target = entry;
+    });
+}
+
+EntryStore::Version &EntryStore::detachVersion() {
+    // 有快照持有当前版本时复制块指针表，块本身仍与快照共享
+    if (m_current.use_count() > 1) {
+        m_current = std::make_shared<Version>(*m_current);
+    }
+    ++m_current->number;
+    return *m_current;
+}
+
+EntryStore::Chunk &EntryStore::detachChunk(int chunk) {
+    // 非 const 访问先使指针表脱离共享，再按引用计数判断块是否被旧版本持有
+    std::shared_ptr<Chunk> &data = m_current->chunks[chunk];
+    if (data.use_count() > 1) {
+        data = std::make_shared<Chunk>(*data);
+    }
+    return *data;
+}
+
+TsEntry &EntryStore::detachEntry(int index) {
+    detachVersion();
+    return detachChunk(index >> ChunkShift)[index & ChunkMask];
+}
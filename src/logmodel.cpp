@@ -0,0 +1,170 @@
+#include "logmodel.h"
+
+#include <QColor>
+#include <QDateTime>
+
+// ---------------- LogFileSink ----------------
+
+LogFileSink::LogFileSink(const QString &filePath)
+    : m_filePath(filePath), m_writer(new QObject) {
+    m_file = new QFile(filePath, m_writer);
+    m_openSucceeded = m_file->open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Text);
+
+    // 文件随写入对象一起移动到写入线程
+    m_writer->moveToThread(&m_thread);
+    m_thread.setObjectName("LogFileSink");
+    m_thread.start(QThread::LowPriority);
+}
+
+LogFileSink::~LogFileSink() {
+    // 等待已排队的写入全部完成后再退出线程
+    if (m_thread.isRunning()) {
+        QMetaObject::invokeMethod(m_writer, [] {}, Qt::BlockingQueuedConnection);
+    }
+    m_thread.quit();
+    m_thread.wait();
+    m_file->close();
+    delete m_writer;
+}
+
+void LogFileSink::appendLines(const QStringList &lines) {
+    if (!m_openSucceeded || lines.isEmpty()) {
+        return;
+    }
+    QMetaObject::invokeMethod(m_writer, [this, lines] {
+        writeLines(lines);
+    }, Qt::QueuedConnection);
+}
+
+void LogFileSink::writeLines(const QStringList &lines) {
+    QByteArray data = lines.join('\n').toUtf8();
+    data.append('\n');
+    m_file->write(data);
+    m_file->flush();
+}
+
+// ---------------- LogModel ----------------
+
+LogModel::LogModel(int capacity, QObject *parent)
+    : QAbstractListModel(parent), m_capacity(qMax(1, capacity)), m_ring(m_capacity) {
+    // 一帧（约16ms）内的追加合并为一次视图更新
+    m_flushTimer.setSingleShot(true);
+    m_flushTimer.setInterval(16);
+    connect(&m_flushTimer, &QTimer::timeout, this, &LogModel::flush);
+}
+
+LogModel::~LogModel() {
+    flush();
+    delete m_sink;
+}
+
+int LogModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : m_size;
+}
+
+QVariant LogModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_size) {
+        return QVariant();
+    }
+
+    const LogRecord &record = recordAt(index.row());
+    switch (role) {
+        case Qt::DisplayRole:
+        case Qt::ToolTipRole:
+            return record.text;
+        case Qt::ForegroundRole:
+            return record.error ? QColor(Qt::red) : QColor(Qt::blue);
+        default:
+            return QVariant();
+    }
+}
+
+void LogModel::appendMessage(const QString &message) {
+    append(message, false);
+}
+
+void LogModel::appendError(const QString &error) {
+    append(error, true);
+}
+
+void LogModel::append(const QString &text, bool error) {
+    QString timestamp = QDateTime::currentDateTime().toString("[hh:mm:ss] ");
+    m_pending.append({timestamp + text, error});
+    if (!m_flushTimer.isActive()) {
+        m_flushTimer.start();
+    }
+}
+
+const LogModel::LogRecord &LogModel::recordAt(int row) const {
+    return m_ring.at((m_start + row) % m_capacity);
+}
+
+void LogModel::flush() {
+    if (m_pending.isEmpty()) {
+        return;
+    }
+
+    QVector<LogRecord> incoming;
+    incoming.swap(m_pending);
+
+    if (m_sink) {
+        QStringList lines;
+        lines.reserve(incoming.size());
+        for (const LogRecord &record : incoming) {
+            lines.append(record.text);
+        }
+        m_sink->appendLines(lines);
+    }
+
+    // 超出容量的部分只写入文件，不进入视图
+    int skip = qMax(0, incoming.size() - m_capacity);
+    int count = incoming.size() - skip;
+
+    int overflow = qMax(0, m_size + count - m_capacity);
+    if (overflow > 0) {
+        beginRemoveRows(QModelIndex(), 0, overflow - 1);
+        m_start = (m_start + overflow) % m_capacity;
+        m_size -= overflow;
+        endRemoveRows();
+    }
+
+    beginInsertRows(QModelIndex(), m_size, m_size + count - 1);
+    for (int i = skip; i < incoming.size(); ++i) {
+        m_ring[(m_start + m_size) % m_capacity] = std::move(incoming[i]);
+        m_size++;
+    }
+    endInsertRows();
+
+    emit rowsFlushed();
+}
+
+void LogModel::clear() {
+    beginResetModel();
+    m_pending.clear();
+    m_ring.fill(LogRecord());
+    m_start = 0;
+    m_size = 0;
+    endResetModel();
+}
+
+bool LogModel::setFileSink(const QString &filePath) {
+    flush();
+    delete m_sink;
+    m_sink = nullptr;
+
+    if (filePath.isEmpty()) {
+        return true;
+    }
+
+    m_sink = new LogFileSink(filePath);
+    if (!m_sink->isOpen()) {
+        delete m_sink;
+        m_sink = nullptr;
+        return false;
+    }
+    return true;
+}
+
+QString LogModel::fileSinkPath() const {
+    return m_sink ? m_sink->filePath() : QString();
+}
@@ -1,38 +1,86 @@
 #include "../include/logoutputwidget.h"
-#include <QDateTime>
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QScrollBar>
+#include <QSettings>
 
 LogOutputWidget::LogOutputWidget(QWidget *parent)
     : QWidget(parent) {
 
-    // 创建日志文本框
-    m_logTextEdit = new QTextEdit(this);
-    m_logTextEdit->setReadOnly(true);
-    m_logTextEdit->setFont(QFont("Consolas", 10));
+    // 创建日志模型与视图（固定容量，只绘制可见行）
+    m_logModel = new LogModel(10000, this);
+    m_logView = new QListView(this);
+    m_logView->setModel(m_logModel);
+    m_logView->setUniformItemSizes(true);
+    m_logView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_logView->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_logView->setFont(QFont("Consolas", 10));
 
     // 创建清除按钮
     m_clearButton = new QPushButton("清除日志", this);
+    m_fileSinkCheck = new QCheckBox("写入日志文件", this);
 
     // 布局
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addWidget(m_fileSinkCheck);
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_clearButton);
+
     QVBoxLayout *layout = new QVBoxLayout(this);
-    layout->addWidget(m_logTextEdit);
-    layout->addWidget(m_clearButton);
+    layout->addWidget(m_logView);
+    layout->addLayout(buttonLayout);
 
     setLayout(layout);
 
     // 连接信号
     connect(m_clearButton, &QPushButton::clicked, this, &LogOutputWidget::clearLog);
+    connect(m_fileSinkCheck, &QCheckBox::toggled, this, &LogOutputWidget::onFileSinkToggled);
+    connect(m_logModel, &LogModel::rowsFlushed, this, &LogOutputWidget::onRowsFlushed);
+
+    QSettings settings;
+    QString savedPath = settings.value("Log/filePath").toString();
+    if (!savedPath.isEmpty() && m_logModel->setFileSink(savedPath)) {
+        QSignalBlocker blocker(m_fileSinkCheck);
+        m_fileSinkCheck->setChecked(true);
+        m_fileSinkCheck->setToolTip(savedPath);
+    }
 }
 
 void LogOutputWidget::appendMessage(const QString &message) {
-    QString timestamp = QDateTime::currentDateTime().toString("[hh:mm:ss] ");
-    m_logTextEdit->append("<span style='color:blue'>" + timestamp + message + "</span>");
+    m_logModel->appendMessage(message);
 }
 
 void LogOutputWidget::appendError(const QString &error) {
-    QString timestamp = QDateTime::currentDateTime().toString("[hh:mm:ss] ");
-    m_logTextEdit->append("<span style='color:red'>" + timestamp + error + "</span>");
+    m_logModel->appendError(error);
 }
 
 void LogOutputWidget::clearLog() {
-    m_logTextEdit->clear();
-}
\ No newline at end of file
+    m_logModel->clear();
+}
+
+void LogOutputWidget::onRowsFlushed() {
+    // 仅当用户停留在底部时自动滚动
+    QScrollBar *scrollBar = m_logView->verticalScrollBar();
+    if (scrollBar->value() >= scrollBar->maximum() - 1) {
+        m_logView->scrollToBottom();
+    }
+}
+
+void LogOutputWidget::onFileSinkToggled(bool enabled) {
+    QSettings settings;
+    if (!enabled) {
+        m_logModel->setFileSink(QString());
+        m_fileSinkCheck->setToolTip(QString());
+        settings.remove("Log/filePath");
+        return;
+    }
+
+    QString filePath = QFileDialog::getSaveFileName(this, "日志文件", "translator.log", "日志文件 (*.log *.txt)");
+    if (filePath.isEmpty() || !m_logModel->setFileSink(filePath)) {
+        QSignalBlocker blocker(m_fileSinkCheck);
+        m_fileSinkCheck->setChecked(false);
+        return;
+    }
+    m_fileSinkCheck->setToolTip(filePath);
+    settings.setValue("Log/filePath", filePath);
+}
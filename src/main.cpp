@@ -1,10 +1,85 @@
 #include "../include/mainwindow.h"
 
 #include <QApplication>
+#include <QTextStream>
+#include "../include/tracerecorder.h"
+#include "../include/qmwriter.h"
+#include "../include/streamtranslator.h"
+#include "../include/translationservice.h"
+
+// 无界面发布：QtTsAutoTranslator --release a.ts b.ts ...，并行生成各自旁边的 .qm
+static int releaseHeadless(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream err(stderr);
+    QStringList tsFiles = app.arguments().mid(2);
+    if (tsFiles.isEmpty()) {
+        err << "用法: " << app.arguments().first() << " --release <文件.ts>...\n";
+        return 2;
+    }
+
+    QStringList failed = QmWriter::releaseFiles(tsFiles);
+    for (const QString &tsFile : failed) {
+        err << "发布失败: " << tsFile << "\n";
+    }
+    return failed.isEmpty() ? 0 : 1;
+}
+
+// 无界面流式翻译：QtTsAutoTranslator --translate 输入.ts [输出.ts] [--window N]，
+// 使用设置中保存的引擎与密钥，未指定输出时覆盖输入文件
+static int translateHeadless(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+    QTextStream err(stderr);
+    QStringList args = app.arguments().mid(2);
+    int windowSize = 256;
+    int windowArg = args.indexOf("--window");
+    if (windowArg >= 0) {
+        windowSize = args.value(windowArg + 1).toInt();
+        args.erase(args.begin() + windowArg, args.begin() + qMin(args.size(), windowArg + 2));
+    }
+    if (args.isEmpty() || args.size() > 2 || windowSize <= 0) {
+        err << "用法: " << app.arguments().first() << " --translate <输入.ts> [输出.ts] [--window N]\n";
+        return 2;
+    }
+
+    TranslationService service;
+    StreamTranslator translator(&service);
+    translator.setWindowSize(windowSize);
+    QObject::connect(&translator, &StreamTranslator::progress, [&err](int translated, int failed, int messages) {
+        err << "已读取 " << messages << " 条，已翻译 " << translated << " 条，失败 " << failed << " 条\n";
+        err.flush();
+    });
+    int result = 1;
+    QObject::connect(&translator, &StreamTranslator::finished, [&app, &err, &result](bool success, const QString &error) {
+        if (!success) {
+            err << "翻译失败: " << error << "\n";
+        }
+        result = success ? 0 : 1;
+        app.exit(result);
+    });
+    // 没有需要翻译的消息时在 start 中就已完成
+    translator.start(args.first(), args.value(1, args.first()));
+    return translator.isRunning() ? app.exec() : result;
+}
 
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && qstrcmp(argv[1], "--release") == 0) {
+        return releaseHeadless(argc, argv);
+    }
+    if (argc > 1 && qstrcmp(argv[1], "--translate") == 0) {
+        return translateHeadless(argc, argv);
+    }
+
     QApplication a(argc, argv);
+    TraceRecorder::instance().startFromEnvironment();
+    QObject::connect(&a, &QCoreApplication::aboutToQuit, [] {
+        TraceRecorder &tracer = TraceRecorder::instance();
+        if (tracer.isEnabled()) {
+            tracer.stop(tracer.environmentOutputPath());
+        }
+    });
     MainWindow w;
     w.show();
     return a.exec();
@@ -1,5 +1,6 @@
 #include "mainwindow.h"
 
+#include <algorithm>
 #include <complex>
 #include <qdebug.h>
 #include "tsfilehandler.h"
@@ -7,10 +8,18 @@
 #include "../include/translationservice.h"
 #include "../include/translationsettingsdialog.h"
 #include <QProgressDialog>
+#include <QApplication>
 #include <QMessageBox>
 #include <QTimer>
 #include <QStatusBar>
 #include <QPropertyAnimation>
+#include <QDockWidget>
+#include <QElapsedTimer>
+#include <QCloseEvent>
+#include "translationmetrics.h"
+#include "tracerecorder.h"
+#include "qmwriter.h"
+#include "streamtranslator.h"
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent) {
     m_translationService = new TranslationService(this);
@@ -18,6 +27,16 @@ MainWindow::MainWindow(QWidget *parent)
             this, &MainWindow::onBatchTranslationCompleted);
     connect(m_translationService, &TranslationService::errorOccurred,
             this, &MainWindow::onTranslationError);
+    connect(m_translationService, &TranslationService::placeholderMismatch,
+            this, &MainWindow::onPlaceholderMismatch);
+    connect(m_translationService, &TranslationService::batchTextTranslated,
+            this, &MainWindow::onBatchTextTranslated);
+
+    // 批量结果先累积，定时整批写入，每批只发出一次范围更新并保存一次
+    m_applyTimer = new QTimer(this);
+    m_applyTimer->setSingleShot(true);
+    m_applyTimer->setInterval(200);
+    connect(m_applyTimer, &QTimer::timeout, this, &MainWindow::applyPendingTranslations);
     setupUi();
 }
 
@@ -27,6 +46,9 @@ void MainWindow::setupUi() {
     m_logWidget = new LogOutputWidget(this);
     m_treeWidget = new TsTreeWidget(this);
     m_treeWidget->setMinimumWidth(300);
+    m_treeWidget->setFileHandler(&m_fileHandler);
+    m_fileHandler.setWatching(true);
+    m_fileHandler.setSnapshotsEnabled(true);
     m_detailWidget = new TsDetailWidget(this);
     QSplitter *mainSplitter = new QSplitter(Qt::Vertical, this);
 
@@ -41,6 +63,26 @@ void MainWindow::setupUi() {
 
     setCentralWidget(mainSplitter);
 
+    m_metricsWidget = new MetricsWidget(this);
+    QDockWidget *metricsDock = new QDockWidget("性能指标", this);
+    metricsDock->setObjectName("metricsDock");
+    metricsDock->setWidget(m_metricsWidget);
+    addDockWidget(Qt::BottomDockWidgetArea, metricsDock);
+    metricsDock->hide();
+
+    m_qaChecker = new QaChecker(&m_fileHandler, this);
+    m_qaWidget = new QaWidget(m_qaChecker, &m_fileHandler, this);
+    QDockWidget *qaDock = new QDockWidget("质量检查", this);
+    qaDock->setObjectName("qaDock");
+    qaDock->setWidget(m_qaWidget);
+    addDockWidget(Qt::BottomDockWidgetArea, qaDock);
+    qaDock->hide();
+    connect(m_qaWidget, &QaWidget::entryActivated, [this](int entry){
+        if (!m_treeWidget->selectEntry(entry)) {
+            m_statusLabel->setText("该条目被当前筛选隐藏");
+        }
+    });
+
     connect(this, &MainWindow::logMessage, m_logWidget, &LogOutputWidget::appendMessage);
     connect(this, &MainWindow::logError, m_logWidget, &LogOutputWidget::appendError);
 
@@ -48,9 +90,12 @@ void MainWindow::setupUi() {
     connect(m_treeWidget, &TsTreeWidget::contextSelected, [this](const QString &contextName){
         int messageCount = m_fileHandler.getContextMessageCount(contextName);
         m_detailWidget->showContextInfo(contextName, messageCount);
+        // 批量翻译优先处理用户正在查看的上下文
+        m_translationService->setPriorityContexts({contextName});
     });
 
     connect(m_treeWidget, &TsTreeWidget::messageSelected, [this](const QString &contextName, const QString &source){
+        m_translationService->setPriorityContexts({contextName});
         TsEntry entry = m_fileHandler.findEntry(contextName, source);
         if (!entry.source.isEmpty()) {
             m_detailWidget->showMessageInfo(contextName, entry.source,
@@ -58,7 +103,33 @@ void MainWindow::setupUi() {
                                             stateToString(entry.state),
                                             entry.locations,
                                             entry.comments);
+            prefetchAfter(m_treeWidget->currentEntry());
+        }
+    });
+
+    // 条目下标变化后，批量翻译中尚未写入的结果随之调整
+    connect(&m_fileHandler, &TsFileHandler::entriesRemoved, [this](const QVector<int> &removed){
+        for (int &index : m_batchEntries) {
+            if (index >= 0) {
+                index = TsFileHandler::remapIndex(removed, index);
+            }
         }
+        for (TsFileHandler::TranslationUpdate &update : m_pendingUpdates) {
+            update.index = TsFileHandler::remapIndex(removed, update.index);
+        }
+        m_pendingUpdates.erase(std::remove_if(m_pendingUpdates.begin(), m_pendingUpdates.end(),
+                                              [](const TsFileHandler::TranslationUpdate &update) {
+                                                  return update.index < 0;
+                                              }), m_pendingUpdates.end());
+    });
+    connect(&m_fileHandler, &TsFileHandler::fileLoaded, [this]{
+        m_batchEntries.clear();
+        m_pendingUpdates.clear();
+    });
+
+    connect(&m_fileHandler, &TsFileHandler::externalChangesMerged, [this](int updated, int added, int removed){
+        logMessage(QString("信息: 文件已被外部修改，已合并（更新 %1 条，新增 %2 条，移除 %3 条），未保存的修改已保留")
+                   .arg(updated).arg(added).arg(removed));
     });
 
     connect(m_detailWidget, &TsDetailWidget::translationChanged,
@@ -74,7 +145,6 @@ void MainWindow::setupUi() {
     connect(m_detailWidget, &TsDetailWidget::saveRequested, [this]{
         if (!m_currentFilePath.isEmpty()) {
             m_fileHandler.save(m_currentFilePath);
-            m_treeWidget->loadTsFile(m_currentFilePath);
         }
     });
 
@@ -82,6 +152,35 @@ void MainWindow::setupUi() {
     QMenu *fileMenu = menuBar->addMenu("文件");
     QAction *openAction = fileMenu->addAction("打开");
     QAction *saveAction = fileMenu->addAction("保存");
+    fileMenu->addSeparator();
+    QAction *releaseAction = fileMenu->addAction("发布 .qm");
+    releaseAction->setShortcut(QKeySequence("Ctrl+R"));
+    connect(releaseAction, &QAction::triggered, this, &MainWindow::releaseCurrentFile);
+    QAction *releaseFilesAction = fileMenu->addAction("批量发布 .qm...");
+    connect(releaseFilesAction, &QAction::triggered, this, &MainWindow::releaseFiles);
+    QAction *mergeAction = fileMenu->addAction("从旧文件合并译文...");
+    connect(mergeAction, &QAction::triggered, this, &MainWindow::mergeFromFile);
+    QAction *streamAction = fileMenu->addAction("流式翻译大文件...");
+    connect(streamAction, &QAction::triggered, this, &MainWindow::streamTranslateFile);
+    fileMenu->addSeparator();
+    QAction *exportMetricsAction = fileMenu->addAction("导出性能指标...");
+    connect(exportMetricsAction, &QAction::triggered, m_metricsWidget, &MetricsWidget::exportJson);
+
+    QMenu *viewMenu = menuBar->addMenu("视图");
+    viewMenu->addAction(metricsDock->toggleViewAction());
+    viewMenu->addAction(qaDock->toggleViewAction());
+    QAction *traceAction = viewMenu->addAction("记录性能追踪");
+    traceAction->setCheckable(true);
+    traceAction->setChecked(TraceRecorder::instance().isEnabled());
+    connect(traceAction, &QAction::toggled, this, &MainWindow::onTraceToggled);
+
+    QMenu *reviewMenu = menuBar->addMenu("审阅");
+    QAction *nextUnfinishedAction = reviewMenu->addAction("下一个未完成");
+    nextUnfinishedAction->setShortcut(QKeySequence("Ctrl+J"));
+    connect(nextUnfinishedAction, &QAction::triggered, this, &MainWindow::selectNextUnfinished);
+    QAction *previousUnfinishedAction = reviewMenu->addAction("上一个未完成");
+    previousUnfinishedAction->setShortcut(QKeySequence("Ctrl+K"));
+    connect(previousUnfinishedAction, &QAction::triggered, this, &MainWindow::selectPreviousUnfinished);
 
     connect(openAction, &QAction::triggered, [this]{
         QString filePath = QFileDialog::getOpenFileName(this, "打开TS文件", "", "TS文件 (*.ts)");
@@ -122,9 +221,40 @@ void MainWindow::setupUi() {
             this, &MainWindow::openTranslationSettings);
     m_translationToolBar->addAction(settingsAction);
 
+    QToolBar *filterToolBar = addToolBar("筛选");
+    filterToolBar->setMovable(false);
+    QComboBox *stateFilterCombo = new QComboBox(this);
+    stateFilterCombo->addItem("全部", TsTreeModel::AllEntries);
+    stateFilterCombo->addItem("未完成", TsTreeModel::UnfinishedEntries);
+    stateFilterCombo->addItem("需审核", TsTreeModel::NeedsReviewEntries);
+    stateFilterCombo->addItem("已废弃", TsTreeModel::ObsoleteEntries);
+    connect(stateFilterCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), [this, stateFilterCombo](int index){
+        m_treeWidget->setStateFilter(static_cast<TsTreeModel::Filter>(stateFilterCombo->itemData(index).toInt()));
+    });
+
+    QLineEdit *contextFilterEdit = new QLineEdit(this);
+    contextFilterEdit->setPlaceholderText("按上下文过滤...");
+    contextFilterEdit->setClearButtonEnabled(true);
+    contextFilterEdit->setMaximumWidth(200);
+    connect(contextFilterEdit, &QLineEdit::textChanged, m_treeWidget, &TsTreeWidget::setContextFilter);
+
+    QComboBox *sortCombo = new QComboBox(this);
+    sortCombo->addItem("文件顺序", TsFilterProxyModel::FileOrder);
+    sortCombo->addItem("源文本长度", TsFilterProxyModel::SourceLength);
+    connect(sortCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), [this, sortCombo](int index){
+        m_treeWidget->setSortMode(static_cast<TsFilterProxyModel::SortMode>(sortCombo->itemData(index).toInt()));
+    });
+
+    filterToolBar->addWidget(new QLabel("筛选:", this));
+    filterToolBar->addWidget(stateFilterCombo);
+    filterToolBar->addWidget(contextFilterEdit);
+    filterToolBar->addWidget(new QLabel("排序:", this));
+    filterToolBar->addWidget(sortCombo);
+
     QSettings settings;
     int savedEngine = settings.value("Translation/currentEngine", TranslationService::GoogleTranslate).toInt();
     m_engineCombo->setCurrentIndex(m_engineCombo->findData(savedEngine));
+    m_prefetchCount = settings.value("Translation/prefetchCount", 3).toInt();
     setMenuBar(menuBar);
 
 
@@ -139,19 +269,30 @@ void MainWindow::setupUi() {
     m_statusProgressBar->setFixedWidth(150);
     m_statusProgressBar->setVisible(false); // 初始隐藏
     statusBar->addPermanentWidget(m_statusProgressBar);
+    m_progressAnimation = new QPropertyAnimation(m_statusProgressBar, "value", this);
+    m_progressAnimation->setDuration(500);
+    m_progressAnimation->setEasingCurve(QEasingCurve::OutQuad);
+    m_progressAggregator = new ProgressAggregator(this);
+    connect(m_progressAggregator, &ProgressAggregator::progressChanged,
+            this, &MainWindow::onAggregatedProgress);
     createProgressBarMenu();
     connect(m_translationService, &TranslationService::batchProgress,
             this, &MainWindow::onBatchProgress);
-    connect(m_translationService, &TranslationService::batchTranslationCompleted,
-            this, &MainWindow::onBatchTranslationCompleted);
     connect(m_translationService, &TranslationService::batchCanceled,
             this, &MainWindow::onBatchTranslationCanceled);
 }
 
+void MainWindow::closeEvent(QCloseEvent *event) {
+    applyPendingTranslations();
+    m_fileHandler.flushSnapshot();
+    QMainWindow::closeEvent(event);
+}
+
 void MainWindow::loadTsFile(const QString &filePath) {
+    m_fileHandler.flushSnapshot();
     if (m_fileHandler.load(filePath)) {
         m_currentFilePath = filePath;
-        m_treeWidget->loadTsFile(filePath);
+        m_translationService->warmUpConnection();
         m_detailWidget->clear();
 
         QFileInfo fileInfo(filePath);
@@ -186,6 +327,27 @@ void MainWindow::openTranslationSettings() {
             m_translationService->setLanguages(engine,
                 dialog.sourceLanguage(engine),
                 dialog.targetLanguage(engine));
+            m_translationService->setRemainingQuota(engine, dialog.remainingQuota(engine));
+        }
+        m_translationService->setShardingEnabled(dialog.shardingEnabled());
+        m_translationService->setPinnedEngine(dialog.pinnedEngine(), dialog.pinnedContexts());
+
+        m_prefetchCount = dialog.prefetchCount();
+        QSettings settings;
+        settings.setValue("Translation/prefetchCount", m_prefetchCount);
+        m_detailWidget->translationService()->setPrefetchBudget(dialog.prefetchBudget());
+
+        // 两个服务实例共用同一份已载入的短语库
+        if (dialog.phrasebooks() != m_translationService->phrasebooks()) {
+            QString phrasebookError;
+            if (!m_translationService->setPhrasebooks(dialog.phrasebooks(), &phrasebookError)) {
+                logError(QString("短语库载入失败: %1").arg(phrasebookError));
+            }
+            m_detailWidget->translationService()->setPhrasebooks(dialog.phrasebooks());
+            if (!dialog.phrasebooks().isEmpty()) {
+                logMessage(QString("信息: 已载入离线短语库，共 %1 条短语")
+                           .arg(m_translationService->phrasebookSize()));
+            }
         }
     }
 }
@@ -198,9 +360,12 @@ void MainWindow::onBatchTranslationRequested() {
     }
     // 收集源文本
     QStringList sourceTexts;
+    QStringList contexts;
+    m_batchEntries = untranslatedIndices.toVector();
     for (int index : untranslatedIndices) {
         TsEntry entry = m_fileHandler.entryAt(index);
         sourceTexts.append(entry.source);
+        contexts.append(entry.context);
     }
 
     QProgressDialog progressDialog("正在批量翻译...", "取消", 0, sourceTexts.size(), this);
@@ -209,57 +374,64 @@ void MainWindow::onBatchTranslationRequested() {
 
     connect(m_translationService, &TranslationService::batchTranslationCompleted,
             &progressDialog, &QProgressDialog::cancel);
-    connect(m_translationService, &TranslationService::singleTranslationCompleted,
-        this, &MainWindow::onSingleTranslationCompleted);
-    m_translationService->translateBatch(sourceTexts);
+    m_translationService->translateBatch(sourceTexts, contexts);
 }
 
-void MainWindow::onSingleTranslationCompleted(const QString &context, const QString &source, const QString &translation) {
-    // 查找包含这个源文本的所有条目
-    QList<int> indices = m_fileHandler.findEntriesBySource(source);
-
-    if (indices.isEmpty()) {
-        logError("警告: 未找到源文本" + source);
-        // qWarning() << "未找到源文本:" << source;
+void MainWindow::onBatchTextTranslated(int batchIndex, const QString &translation, bool intact) {
+    const int index = m_batchEntries.value(batchIndex, -1);
+    if (index < 0 || translation.isEmpty()) {
         return;
     }
-
-    for (int index : indices) {
-        TsEntry entry = m_fileHandler.entryAt(index);
-        if (entry.state == TranslationState::Unfinished) {
-            m_fileHandler.updateEntryTranslation(index, translation);
-            m_fileHandler.updateEntryState(index, TranslationState::Finished);
-
-            // 更新进度
-            // m_progressDialog.setValue(m_progressDialog.value() + 1);
-        }
+    // 翻译期间已被手动处理的条目不覆盖
+    if (!m_fileHandler.stateBitmap(TranslationState::Unfinished).test(index)
+        && !m_fileHandler.emptyTranslationBitmap().test(index)) {
+        return;
     }
-
-    if (!m_currentFilePath.isEmpty()) {
-        m_fileHandler.save(m_currentFilePath);
+    // 占位符丢失的译文写入但保持未完成，可通过“下一个未完成”逐条复核
+    m_pendingUpdates.append({index, translation, intact ? TranslationState::Finished : TranslationState::Unfinished});
+    if (!m_applyTimer->isActive()) {
+        m_applyTimer->start();
     }
-    m_treeWidget->loadTsFile(m_currentFilePath);
 }
-void MainWindow::onBatchTranslationCompleted(const QMap<QString, QString> &results) {
-    QList<int> untranslatedIndices = m_fileHandler.getUntranslatedEntries();
 
-    for (int index : untranslatedIndices) {
-        TsEntry entry = m_fileHandler.entryAt(index);
-        if (results.contains(entry.source)) {
-            m_fileHandler.updateEntryTranslation(index, results[entry.source]);
-            m_fileHandler.updateEntryState(index, TranslationState::Finished);
-        }
+void MainWindow::applyPendingTranslations() {
+    m_applyTimer->stop();
+    if (m_pendingUpdates.isEmpty()) {
+        return;
     }
+    TraceScope trace("MainWindow::applyPendingTranslations", "apply");
+    QElapsedTimer applyTimer;
+    applyTimer.start();
+
+    m_fileHandler.applyTranslations(std::move(m_pendingUpdates));
+    m_pendingUpdates.clear();
+    // 自动保存不重写快照，快照在手动保存、切换文件或关闭窗口时更新
     if (!m_currentFilePath.isEmpty()) {
-        m_fileHandler.save(m_currentFilePath);
+        m_fileHandler.save(m_currentFilePath, false);
     }
-    m_treeWidget->loadTsFile(m_currentFilePath);
+    TranslationMetrics::instance()->recordApply(m_translationService->currentEngine(),
+                                                applyTimer.nsecsElapsed() / 1000);
+}
+
+void MainWindow::onBatchTranslationCompleted(const QMap<QString, QString> &results) {
+    // 结果已按条目下标逐条累积，这里写入最后一批
+    applyPendingTranslations();
+    m_batchEntries.clear();
     logMessage(QString("信息: 批量翻译完成，已翻译 %1 个条目").arg(results.size()));
-    m_statusProgressBar->setVisible(false);
-    m_statusLabel->setText("翻译完成");
-    QTimer::singleShot(5000, this, [this]() {
-        m_statusLabel->setText("就绪");
-    });
+    TranslationMetrics::EngineSummary summary =
+        TranslationMetrics::instance()->summary(m_translationService->currentEngine());
+    logMessage(QString("信息: 网络耗时 p50 %1ms / p95 %2ms，可在“视图-性能指标”中导出JSON")
+                   .arg(summary.network.percentile(50) / 1000)
+                   .arg(summary.network.percentile(95) / 1000));
+    m_progressAggregator->finishJob(reinterpret_cast<quintptr>(m_translationService));
+    if (!m_progressAggregator->isActive()) {
+        m_progressAnimation->stop();
+        m_statusProgressBar->setVisible(false);
+        m_statusLabel->setText("翻译完成");
+        QTimer::singleShot(5000, this, [this]() {
+            m_statusLabel->setText("就绪");
+        });
+    }
 }
 
 void MainWindow::onTranslationError(const QString &errorMessage, const QString &sourceText) {
@@ -270,6 +442,188 @@ void MainWindow::onTranslationError(const QString &errorMessage, const QString &
     // QMessageBox::critical(this, "翻译错误", errorMessage);
 }
 
+void MainWindow::onPlaceholderMismatch(const QString &source, const QString &translation,
+                                       const QStringList &missingTokens) {
+    logError(QString("警告: 译文丢失占位符 %1，已保留为待复核 (源文本: %2)")
+                 .arg(missingTokens.join(' '), source));
+
+    // 批量翻译的结果按条目下标由 onBatchTextTranslated 写入
+    if (m_translationService->isBatchRunning()) {
+        return;
+    }
+
+    // 写入译文但保持未完成状态，可通过“下一个未完成”逐条复核
+    for (int index : m_fileHandler.findEntriesBySource(source)) {
+        if (m_fileHandler.entryAt(index).state == TranslationState::Unfinished) {
+            m_fileHandler.updateEntryTranslation(index, translation);
+        }
+    }
+}
+
+void MainWindow::selectNextUnfinished() {
+    navigateEntries(m_fileHandler.untranslatedBitmap(), true);
+}
+
+void MainWindow::selectPreviousUnfinished() {
+    navigateEntries(m_fileHandler.untranslatedBitmap(), false);
+}
+
+void MainWindow::navigateEntries(const EntryBitmap &set, bool forward) {
+    const int start = m_treeWidget->currentEntry();
+    int entry = start;
+
+    // 跳过被当前筛选隐藏的条目，绕回起点仍未找到则停止
+    for (int tries = set.count(); tries > 0; --tries) {
+        entry = forward ? TsFileHandler::nextEntry(set, entry)
+                        : TsFileHandler::previousEntry(set, entry);
+        if (entry < 0 || entry == start) break;
+        if (m_treeWidget->selectEntry(entry)) return;
+    }
+    m_statusLabel->setText("没有更多未完成的条目");
+}
+
+void MainWindow::releaseCurrentFile() {
+    if (m_currentFilePath.isEmpty()) {
+        m_statusLabel->setText("没有打开的文件");
+        return;
+    }
+
+    // 直接使用内存中的条目，包括尚未保存的修改
+    QString qmPath = QmWriter::qmPath(m_currentFilePath);
+    if (m_fileHandler.release(qmPath)) {
+        logMessage("信息: 已发布 " + qmPath);
+    } else {
+        logError("错误: 无法写入 " + qmPath);
+    }
+}
+
+void MainWindow::releaseFiles() {
+    QStringList tsFiles = QFileDialog::getOpenFileNames(this, "选择要发布的TS文件", "", "TS文件 (*.ts)");
+    if (tsFiles.isEmpty()) {
+        return;
+    }
+
+    QApplication::setOverrideCursor(Qt::WaitCursor);
+    QStringList failed = QmWriter::releaseFiles(tsFiles);
+    QApplication::restoreOverrideCursor();
+
+    for (const QString &tsFile : failed) {
+        logError("错误: 发布失败 " + tsFile);
+    }
+    logMessage(QString("信息: 已发布 %1/%2 个文件").arg(tsFiles.size() - failed.size()).arg(tsFiles.size()));
+}
+
+void MainWindow::streamTranslateFile() {
+    QString inputPath = QFileDialog::getOpenFileName(this, "选择要翻译的TS文件", "", "TS文件 (*.ts)");
+    if (inputPath.isEmpty()) {
+        return;
+    }
+    QString outputPath = QFileDialog::getSaveFileName(this, "保存翻译结果", inputPath, "TS文件 (*.ts)");
+    if (outputPath.isEmpty()) {
+        return;
+    }
+
+    // 不加载到界面，使用独立的翻译服务，不影响当前文件的批量翻译
+    TranslationService *service = new TranslationService(this);
+    StreamTranslator *translator = new StreamTranslator(service, this);
+    // 与批量翻译共用状态栏进度：总数为已读取的消息数，随读取增长
+    const quint64 jobId = reinterpret_cast<quintptr>(translator);
+    connect(translator, &StreamTranslator::progress, [this, jobId](int translated, int failed, int messages){
+        m_progressAggregator->report(jobId, translated + failed, messages);
+    });
+    connect(translator, &StreamTranslator::finished, [this, service, translator, outputPath, jobId](bool success, const QString &error){
+        if (success) {
+            m_progressAggregator->finishJob(jobId);
+        } else {
+            m_progressAggregator->cancelJob(jobId);
+        }
+        if (!m_progressAggregator->isActive()) {
+            m_progressAnimation->stop();
+            m_statusProgressBar->setVisible(false);
+            m_statusLabel->setText(success ? "流式翻译完成" : "流式翻译失败");
+        }
+        if (success) {
+            logMessage("信息: 流式翻译完成，已写入 " + outputPath);
+        } else {
+            logError("错误: 流式翻译失败: " + error);
+        }
+        translator->deleteLater();
+        service->deleteLater();
+    });
+    logMessage("信息: 开始流式翻译 " + inputPath);
+    translator->start(inputPath, outputPath);
+}
+
+void MainWindow::mergeFromFile() {
+    if (m_currentFilePath.isEmpty()) {
+        m_statusLabel->setText("请先打开新提取的TS文件");
+        return;
+    }
+    QString filePath = QFileDialog::getOpenFileName(this, "选择包含旧译文的TS文件", "", "TS文件 (*.ts)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+
+    TsFileHandler previous;
+    if (!previous.load(filePath)) {
+        logError("错误: 无法读取 " + filePath);
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+    TsFileHandler::MergeReport report = m_fileHandler.mergeTranslations(previous.entries());
+    m_detailWidget->clear();
+
+    logMessage(QString("信息: 合并完成（%1 ms）：精确匹配 %2 条，按源文本匹配 %3 条（待复核），"
+                       "无译文 %4 条，vanished %5 条，obsolete %6 条，冲突 %7 条")
+               .arg(timer.elapsed()).arg(report.exactMatches).arg(report.sourceMatches)
+               .arg(report.untranslated).arg(report.vanished).arg(report.obsolete)
+               .arg(report.conflicts.size()));
+    for (const TsFileHandler::MergeConflict &conflict : std::as_const(report.conflicts)) {
+        logError(QString("冲突: [%1] %2 -> %3").arg(conflict.context, conflict.source,
+                                                     conflict.candidates.join(" | ")));
+    }
+}
+
+void MainWindow::prefetchAfter(int index) {
+    if (m_prefetchCount <= 0 || index < 0) {
+        return;
+    }
+
+    // 审阅者通常按顺序处理同一上下文，预先翻译随后的未完成条目
+    const EntryBitmap untranslated = m_fileHandler.untranslatedBitmap();
+    const QString context = m_fileHandler.entryAt(index).context;
+    QStringList sources;
+    for (int entry = TsFileHandler::nextEntry(untranslated, index, false);
+         entry >= 0 && sources.size() < m_prefetchCount;
+         entry = TsFileHandler::nextEntry(untranslated, entry, false)) {
+        const TsEntry &next = m_fileHandler.entries().at(entry);
+        if (next.context != context) break;
+        sources.append(next.source);
+    }
+    m_detailWidget->translationService()->prefetch(sources);
+}
+
+void MainWindow::onTraceToggled(bool enabled) {
+    TraceRecorder &tracer = TraceRecorder::instance();
+    if (enabled) {
+        tracer.start();
+        logMessage("信息: 已开始记录性能追踪");
+        return;
+    }
+
+    QString filePath = tracer.environmentOutputPath();
+    if (filePath.isEmpty()) {
+        filePath = QFileDialog::getSaveFileName(this, "保存性能追踪", "trace.json", "Chrome Trace (*.json)");
+    }
+    if (tracer.stop(filePath) && !filePath.isEmpty()) {
+        logMessage("信息: 性能追踪已保存到 " + filePath);
+    } else if (!filePath.isEmpty()) {
+        logError("错误: 无法写入性能追踪文件 " + filePath);
+    }
+}
+
 void MainWindow::onEngineChanged(int index) {
     TranslationService::Engine engine = static_cast<TranslationService::Engine>(
         m_engineCombo->itemData(index).toInt());
@@ -285,26 +639,40 @@ void MainWindow::logError(const QString &error) {
 }
 
 void MainWindow::onBatchProgress(int current, int total) {
+    // 高频进度事件交给汇总器，每帧最多刷新一次界面
+    m_progressAggregator->report(reinterpret_cast<quintptr>(sender()), current, total);
+}
+
+void MainWindow::onAggregatedProgress(int done, int total, double itemsPerSecond, qint64 etaMs) {
     if (!m_statusProgressBar->isVisible()) {
         m_statusProgressBar->setVisible(true);
     }
 
-    int progress = total > 0 ? (current * 100) / total : 0;
+    int progress = total > 0 ? (done * 100) / total : 0;
+
+    // 复用同一个动画，只更新目标值
+    if (m_progressAnimation->endValue().toInt() != progress) {
+        m_progressAnimation->stop();
+        m_progressAnimation->setStartValue(m_statusProgressBar->value());
+        m_progressAnimation->setEndValue(progress);
+        m_progressAnimation->start();
+    }
 
-    QPropertyAnimation *animation = new QPropertyAnimation(m_statusProgressBar, "value");
-    animation->setDuration(500);
-    animation->setStartValue(m_statusProgressBar->value());
-    animation->setEndValue(progress);
-    animation->setEasingCurve(QEasingCurve::OutQuad);
-    animation->start(QAbstractAnimation::DeleteWhenStopped);
+    QString etaText = "--:--";
+    if (etaMs >= 0) {
+        qint64 seconds = etaMs / 1000;
+        etaText = QString("%1:%2").arg(seconds / 60).arg(seconds % 60, 2, 10, QChar('0'));
+    }
 
-    m_statusLabel->setText(QString("翻译中: %1/%2 (%3%)")
-                          .arg(current)
+    m_statusLabel->setText(QString("翻译中: %1/%2 (%3%)  %4 条/秒  剩余 %5")
+                          .arg(done)
                           .arg(total)
-                          .arg(progress));
+                          .arg(progress)
+                          .arg(itemsPerSecond, 0, 'f', 1)
+                          .arg(etaText));
 
     m_statusProgressBar->setToolTip(QString("已翻译: %1/%2 (%3%)")
-                                   .arg(current)
+                                   .arg(done)
                                    .arg(total)
                                    .arg(progress));
     if (progress < 30) {
@@ -317,6 +685,12 @@ void MainWindow::onBatchProgress(int current, int total) {
 }
 
 void MainWindow::setProgressBarColor(const QString &color) {
+    // 颜色未变化时不重新设置样式表，避免重复 polish
+    if (color == m_progressColor) {
+        return;
+    }
+    m_progressColor = color;
+
     QString style = QString(
         "QProgressBar {"
         "   border: 1px solid #c0c0c0;"
@@ -334,11 +708,18 @@ void MainWindow::setProgressBarColor(const QString &color) {
 }
 
 void MainWindow::onBatchTranslationCanceled() {
-    m_statusProgressBar->setVisible(false);
-    m_statusLabel->setText("翻译已取消");
-    QTimer::singleShot(5000, this, [this]() {
-        m_statusLabel->setText("就绪");
-    });
+    applyPendingTranslations();
+    m_batchEntries.clear();
+    // 仍在进行的流式翻译继续显示进度
+    m_progressAggregator->cancelJob(reinterpret_cast<quintptr>(m_translationService));
+    if (!m_progressAggregator->isActive()) {
+        m_progressAnimation->stop();
+        m_statusProgressBar->setVisible(false);
+        m_statusLabel->setText("翻译已取消");
+        QTimer::singleShot(5000, this, [this]() {
+            m_statusLabel->setText("就绪");
+        });
+    }
 }
 
 void MainWindow::createProgressBarMenu() {
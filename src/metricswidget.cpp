@@ -0,0 +1,104 @@
+#include "metricswidget.h"
+
+#include <QFileDialog>
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QMessageBox>
+#include <QVBoxLayout>
+#include "translationmetrics.h"
+
+namespace {
+QString formatMs(qint64 us) {
+    return QString::number(us / 1000.0, 'f', 1);
+}
+}
+
+MetricsWidget::MetricsWidget(QWidget *parent)
+    : QWidget(parent) {
+
+    m_table = new QTableWidget(this);
+    m_table->setColumnCount(12);
+    m_table->setHorizontalHeaderLabels({"引擎", "请求", "错误", "进行中",
+                                        "排队p50(ms)", "网络p50(ms)", "网络p95(ms)", "网络p99(ms)",
+                                        "解析p95(ms)", "应用p95(ms)", "请求/秒", "字符/秒"});
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionMode(QAbstractItemView::NoSelection);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::ResizeToContents);
+
+    m_exportButton = new QPushButton("导出JSON", this);
+    m_resetButton = new QPushButton("重置", this);
+
+    QHBoxLayout *buttonLayout = new QHBoxLayout;
+    buttonLayout->addStretch();
+    buttonLayout->addWidget(m_resetButton);
+    buttonLayout->addWidget(m_exportButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addWidget(m_table);
+    layout->addLayout(buttonLayout);
+    setLayout(layout);
+
+    // 仅在面板可见时定时刷新
+    m_refreshTimer.setInterval(500);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &MetricsWidget::refresh);
+    connect(m_exportButton, &QPushButton::clicked, this, &MetricsWidget::exportJson);
+    connect(m_resetButton, &QPushButton::clicked, [this]{
+        TranslationMetrics::instance()->reset();
+        refresh();
+    });
+}
+
+void MetricsWidget::refresh() {
+    TranslationMetrics *metrics = TranslationMetrics::instance();
+    QList<TranslationService::Engine> engines = metrics->engines();
+    m_table->setRowCount(engines.size());
+
+    for (int row = 0; row < engines.size(); ++row) {
+        TranslationMetrics::EngineSummary summary = metrics->summary(engines.at(row));
+        QStringList values = {
+            TranslationService::engineName(engines.at(row)),
+            QString::number(summary.requests),
+            QString::number(summary.errors),
+            QString::number(summary.inFlight),
+            formatMs(summary.queueWait.percentile(50)),
+            formatMs(summary.network.percentile(50)),
+            formatMs(summary.network.percentile(95)),
+            formatMs(summary.network.percentile(99)),
+            formatMs(summary.parse.percentile(95)),
+            formatMs(summary.apply.percentile(95)),
+            QString::number(summary.requestsPerSecond, 'f', 2),
+            QString::number(summary.charactersPerSecond, 'f', 0)
+        };
+
+        for (int column = 0; column < values.size(); ++column) {
+            QTableWidgetItem *item = m_table->item(row, column);
+            if (!item) {
+                item = new QTableWidgetItem;
+                m_table->setItem(row, column, item);
+            }
+            item->setText(values.at(column));
+        }
+    }
+}
+
+void MetricsWidget::exportJson() {
+    QString filePath = QFileDialog::getSaveFileName(this, "导出性能指标", "metrics.json", "JSON文件 (*.json)");
+    if (filePath.isEmpty()) {
+        return;
+    }
+    if (!TranslationMetrics::instance()->exportJson(filePath)) {
+        QMessageBox::warning(this, "导出失败", "无法写入文件: " + filePath);
+    }
+}
+
+void MetricsWidget::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    refresh();
+    m_refreshTimer.start();
+}
+
+void MetricsWidget::hideEvent(QHideEvent *event) {
+    QWidget::hideEvent(event);
+    m_refreshTimer.stop();
+}
@@ -0,0 +1,351 @@
+#include "phrasebook.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QRegularExpression>
+#include <QXmlStreamReader>
+#include <algorithm>
+#include "placeholdermasker.h"
+
+namespace {
+
+const QRegularExpression &sentinelPattern() {
+    static const QRegularExpression pattern("\\{(\\d+)\\}");
+    return pattern;
+}
+
+// 把哨兵按出现顺序重新编号为 {0}、{1}…，order[新编号] 为原编号。
+// 句段中的哨兵沿用整条文本的编号，重新编号后才能与短语库中的键比较
+QString canonicalize(const QString &masked, QVector<int> &order) {
+    QString result;
+    result.reserve(masked.size());
+    int last = 0;
+    QRegularExpressionMatchIterator it = sentinelPattern().globalMatch(masked);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        const int index = match.captured(1).toInt();
+        int position = order.indexOf(index);
+        if (position < 0) {
+            position = order.size();
+            order.append(index);
+        }
+        result += masked.mid(last, match.capturedStart() - last);
+        result += QString("{%1}").arg(position);
+        last = match.capturedEnd();
+    }
+    result += masked.mid(last);
+    return result;
+}
+
+// 把 {k} 替换为 {order[k]}
+QString renumber(const QString &masked, const QVector<int> &order) {
+    QString result;
+    result.reserve(masked.size());
+    int last = 0;
+    QRegularExpressionMatchIterator it = sentinelPattern().globalMatch(masked);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        const int index = match.captured(1).toInt();
+        result += masked.mid(last, match.capturedStart() - last);
+        result += QString("{%1}").arg(index < order.size() ? order.at(index) : index);
+        last = match.capturedEnd();
+    }
+    result += masked.mid(last);
+    return result;
+}
+
+// 去掉结尾的冒号、省略号与空白，suffix 返回被去掉的部分；全部是这些字符时原样返回
+QString stripSuffix(const QString &text, QString &suffix) {
+    int end = text.size();
+    while (end > 0) {
+        const QChar c = text.at(end - 1);
+        if (end >= 3 && text.at(end - 1) == '.' && text.at(end - 2) == '.' && text.at(end - 3) == '.') {
+            end -= 3;
+        } else if (c == ':' || c == QChar(0xFF1A) || c == QChar(0x2026) || c.isSpace()) {
+            --end;
+        } else {
+            break;
+        }
+    }
+    if (end == 0) {
+        suffix.clear();
+        return text;
+    }
+    suffix = text.mid(end).trimmed();
+    return text.left(end);
+}
+
+QString normalize(const QString &masked, QString &suffix) {
+    return stripSuffix(masked.simplified(), suffix).toCaseFolded();
+}
+
+QList<QStringList> parseCsv(const QString &content) {
+    QList<QStringList> rows;
+    QStringList row;
+    QString field;
+    bool quoted = false;
+    for (int i = 0; i < content.size(); ++i) {
+        const QChar c = content.at(i);
+        if (quoted) {
+            if (c != '"') {
+                field += c;
+            } else if (i + 1 < content.size() && content.at(i + 1) == '"') {
+                field += c;     // "" 表示字段中的引号
+                ++i;
+            } else {
+                quoted = false;
+            }
+        } else if (c == '"') {
+            quoted = true;
+        } else if (c == ',') {
+            row.append(field);
+            field.clear();
+        } else if (c == '\n' || c == '\r') {
+            if (c == '\r' && i + 1 < content.size() && content.at(i + 1) == '\n') {
+                ++i;
+            }
+            row.append(field);
+            field.clear();
+            rows.append(row);
+            row.clear();
+        } else {
+            field += c;
+        }
+    }
+    if (!field.isEmpty() || !row.isEmpty()) {
+        row.append(field);
+        rows.append(row);
+    }
+    return rows;
+}
+
+} // namespace
+
+std::shared_ptr<const Phrasebook> Phrasebook::open(const QStringList &fileNames, QString *errorMessage) {
+    if (errorMessage) {
+        errorMessage->clear();
+    }
+    if (fileNames.isEmpty()) {
+        return nullptr;
+    }
+
+    // 每个 TranslationService 实例都会载入同一组文件，文件未修改时共用已建好的实例（仅GUI线程）
+    static QHash<QString, std::weak_ptr<const Phrasebook>> loaded;
+    QStringList signature;
+    for (const QString &fileName : fileNames) {
+        QFileInfo info(fileName);
+        signature.append(QString("%1|%2|%3").arg(info.absoluteFilePath()).arg(info.size())
+                         .arg(info.lastModified().toMSecsSinceEpoch()));
+    }
+    const QString key = signature.join('\n');
+    if (std::shared_ptr<const Phrasebook> cached = loaded.value(key).lock()) {
+        return cached;
+    }
+
+    QList<Phrase> phrases;
+    QStringList errors;
+    for (const QString &fileName : fileNames) {
+        QString error;
+        const bool csv = QFileInfo(fileName).suffix().compare("csv", Qt::CaseInsensitive) == 0;
+        if (!(csv ? readCsv(fileName, phrases, error) : readQph(fileName, phrases, error))) {
+            errors.append(QString("%1: %2").arg(QFileInfo(fileName).fileName(), error));
+        }
+    }
+
+    std::shared_ptr<Phrasebook> phrasebook(new Phrasebook);
+    phrasebook->build(phrases);
+    if (errorMessage) {
+        *errorMessage = errors.join('\n');
+    }
+    if (errors.isEmpty()) {
+        loaded.insert(key, phrasebook);
+    }
+    return phrasebook;
+}
+
+bool Phrasebook::readQph(const QString &fileName, QList<Phrase> &phrases, QString &error) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+
+    QXmlStreamReader reader(&file);
+    Phrase phrase;
+    while (!reader.atEnd()) {
+        reader.readNext();
+        if (reader.isStartElement()) {
+            if (reader.name() == QLatin1String("phrase")) {
+                phrase = Phrase();
+            } else if (reader.name() == QLatin1String("source")) {
+                phrase.source = reader.readElementText();
+            } else if (reader.name() == QLatin1String("target")) {
+                phrase.target = reader.readElementText();
+            }
+        } else if (reader.isEndElement() && reader.name() == QLatin1String("phrase")) {
+            phrases.append(phrase);
+        }
+    }
+    if (reader.hasError()) {
+        error = QString("第 %1 行: %2").arg(reader.lineNumber()).arg(reader.errorString());
+        return false;
+    }
+    return true;
+}
+
+bool Phrasebook::readCsv(const QString &fileName, QList<Phrase> &phrases, QString &error) {
+    QFile file(fileName);
+    if (!file.open(QIODevice::ReadOnly)) {
+        error = file.errorString();
+        return false;
+    }
+
+    QString content = QString::fromUtf8(file.readAll());
+    if (content.startsWith(QChar(0xFEFF))) {
+        content.remove(0, 1);
+    }
+    const QList<QStringList> rows = parseCsv(content);
+    for (int i = 0; i < rows.size(); ++i) {
+        const QStringList &row = rows.at(i);
+        if (row.size() < 2 || row.at(0).isEmpty()) {
+            continue;
+        }
+        // 可选的表头行
+        if (i == 0 && (row.at(0).compare("source", Qt::CaseInsensitive) == 0 || row.at(0) == "原文")) {
+            continue;
+        }
+        phrases.append({row.at(0), row.at(1)});
+    }
+    return true;
+}
+
+void Phrasebook::build(const QList<Phrase> &phrases) {
+    QHash<QString, int> exact;
+    QHash<QString, int> normalized;
+    for (const Phrase &phrase : phrases) {
+        const PlaceholderMasker::MaskedText source = PlaceholderMasker::mask(phrase.source);
+        if (!source.needsTranslation || phrase.target.isEmpty() || exact.contains(source.masked)) {
+            continue;
+        }
+
+        // 译文的哨兵改用原文的编号；原文中没有的占位符无法还原，跳过该短语
+        const PlaceholderMasker::MaskedText target = PlaceholderMasker::mask(phrase.target);
+        QVector<int> order;
+        bool valid = true;
+        for (const QString &token : target.tokens) {
+            const int index = source.tokens.indexOf(token);
+            valid = valid && index >= 0;
+            order.append(index);
+        }
+        if (!valid) {
+            continue;
+        }
+        const QString translation = renumber(target.masked, order);
+        exact.insert(source.masked, m_translations.size());
+        m_translations.append(translation);
+
+        QString suffix;
+        const QString key = normalize(source.masked, suffix);
+        if (!normalized.contains(key)) {
+            normalized.insert(key, m_translations.size());
+            m_translations.append(stripSuffix(translation, suffix));
+        }
+    }
+    m_size = exact.size();
+
+    auto buildTrie = [](Trie &trie, const QHash<QString, int> &entries) {
+        QStringList keys = entries.keys();
+        std::sort(keys.begin(), keys.end());
+        QVector<int> values;
+        values.reserve(keys.size());
+        for (const QString &key : std::as_const(keys)) {
+            values.append(entries.value(key));
+        }
+        trie.build(keys, values);
+    };
+    buildTrie(m_exact, exact);
+    buildTrie(m_normalized, normalized);
+}
+
+bool Phrasebook::lookup(const QString &masked, QString &translation) const {
+    QVector<int> order;
+    const QString key = canonicalize(masked, order);
+    QString suffix;
+    int value = m_exact.find(key);
+    if (value < 0) {
+        value = m_normalized.find(normalize(key, suffix));
+        if (value < 0) {
+            return false;
+        }
+    }
+
+    // 规范化匹配时补回原文结尾的冒号或省略号
+    translation = renumber(m_translations.at(value), order);
+    if (!suffix.isEmpty() && !translation.endsWith(suffix)) {
+        translation += suffix;
+    }
+    return true;
+}
+
+void Phrasebook::Trie::build(const QStringList &keys, const QVector<int> &values) {
+    m_nodes.clear();
+    m_labels.clear();
+    m_children.clear();
+    m_nodes.append(Node());
+
+    // 按深度优先展开：每个键区间先处理恰好在此结束的键（排序后位于最前），
+    // 再按下一个字符分组，一次性追加该节点的全部子边
+    struct Range {
+        int node;
+        int begin;
+        int end;
+        int depth;
+    };
+    QVector<Range> stack = {{0, 0, keys.size(), 0}};
+    while (!stack.isEmpty()) {
+        const Range range = stack.takeLast();
+        int begin = range.begin;
+        if (begin < range.end && keys.at(begin).size() == range.depth) {
+            m_nodes[range.node].value = values.at(begin);
+            ++begin;
+        }
+
+        const int firstEdge = m_labels.size();
+        while (begin < range.end) {
+            const QChar label = keys.at(begin).at(range.depth);
+            int end = begin + 1;
+            while (end < range.end && keys.at(end).at(range.depth) == label) {
+                ++end;
+            }
+            m_labels.append(label);
+            m_children.append(m_nodes.size());
+            stack.append({m_nodes.size(), begin, end, range.depth + 1});
+            m_nodes.append(Node());
+            begin = end;
+        }
+        m_nodes[range.node].firstEdge = firstEdge;
+        m_nodes[range.node].edgeCount = m_labels.size() - firstEdge;
+    }
+}
+
+int Phrasebook::Trie::find(const QString &key) const {
+    if (m_nodes.isEmpty()) {
+        return -1;
+    }
+    int node = 0;
+    for (const QChar c : key) {
+        const Node &current = m_nodes.at(node);
+        const auto first = m_labels.cbegin() + current.firstEdge;
+        const auto last = first + current.edgeCount;
+        const auto edge = std::lower_bound(first, last, c, [](QChar a, QChar b) {
+            return a.unicode() < b.unicode();
+        });
+        if (edge == last || *edge != c) {
+            return -1;
+        }
+        node = m_children.at(static_cast<int>(edge - m_labels.cbegin()));
+    }
+    return m_nodes.at(node).value;
+}
@@ -0,0 +1,140 @@
+#include "placeholdermasker.h"
+
+#include <QRegularExpression>
+
+namespace {
+
+// 需要原样保留的片段，按优先级排列
+const QRegularExpression &tokenPattern() {
+    static const QRegularExpression pattern(
+        "%L?(?:\\d{1,2}|n)(?!\\$)"                                       // Qt 参数 %1、%L1、%n
+        "|%(?:\\d+\\$)?[-+#0]*\\d*(?:\\.\\d+)?(?:hh|h|ll|l)?[diouxXeEfgGcsp]" // printf 格式符
+        "|<[^<>]+>"                                                     // HTML/富文本标签
+        "|&(?:[A-Za-z][A-Za-z0-9]*|#\\d+|#x[0-9A-Fa-f]+);"              // HTML 实体
+        "|&&"                                                           // 转义的 &
+        "|\\{\\d+\\}"                                                   // 原文中已有的 {n}
+        "|&(?=[^\\s&])");                                               // 快捷键标记
+    return pattern;
+}
+
+const QRegularExpression &sentinelPattern() {
+    // 引擎偶尔会在花括号内加空格
+    static const QRegularExpression pattern("\\{\\s*(\\d+)\\s*\\}");
+    return pattern;
+}
+
+bool containsLetter(const QString &text, int from, int to) {
+    for (int i = from; i < to; ++i) {
+        if (text.at(i).isLetter()) return true;
+    }
+    return false;
+}
+
+} // namespace
+
+PlaceholderMasker::MaskedText PlaceholderMasker::mask(const QString &text) {
+    MaskedText result;
+    result.source = text;
+    result.masked.reserve(text.size());
+    result.needsTranslation = false;
+
+    int last = 0;
+    QRegularExpressionMatchIterator it = tokenPattern().globalMatch(text);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        int start = match.capturedStart();
+        result.masked += text.mid(last, start - last);
+        result.needsTranslation = result.needsTranslation || containsLetter(text, last, start);
+        last = match.capturedEnd();
+
+        QString token = match.captured();
+        if (token == "&") {
+            // 只记录第一个快捷键，其余直接去掉
+            if (result.accelerator.isNull() && last < text.size()) {
+                result.accelerator = text.at(last);
+            }
+            continue;
+        }
+
+        int index = result.tokens.indexOf(token);
+        if (index < 0) {
+            index = result.tokens.size();
+            result.tokens.append(token);
+        }
+        result.masked += QString("{%1}").arg(index);
+    }
+    result.masked += text.mid(last);
+    result.needsTranslation = result.needsTranslation || containsLetter(text, last, text.size());
+    return result;
+}
+
+QVector<PlaceholderMasker::MaskedText> PlaceholderMasker::maskAll(const QStringList &texts) {
+    QVector<MaskedText> results;
+    results.reserve(texts.size());
+    for (const QString &text : texts) {
+        results.append(mask(text));
+    }
+    return results;
+}
+
+QStringList PlaceholderMasker::unmask(const MaskedText &masked, const QString &translated, QString &result) {
+    // 快捷键在替换哨兵之前恢复，避免插入到标签或实体内部
+    QString text = restoreAccelerator(translated, masked.accelerator);
+
+    QVector<bool> seen(masked.tokens.size(), false);
+    result.clear();
+    result.reserve(text.size() + masked.source.size());
+
+    int last = 0;
+    QRegularExpressionMatchIterator it = sentinelPattern().globalMatch(text);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        int index = match.captured(1).toInt();
+        if (index < 0 || index >= masked.tokens.size()) {
+            continue;   // 不是我们生成的哨兵，原样保留
+        }
+        result += text.mid(last, match.capturedStart() - last);
+        result += masked.tokens.at(index);
+        seen[index] = true;
+        last = match.capturedEnd();
+    }
+    result += text.mid(last);
+
+    QStringList missing;
+    for (int i = 0; i < seen.size(); ++i) {
+        if (!seen.at(i)) {
+            missing.append(masked.tokens.at(i));
+        }
+    }
+    return missing;
+}
+
+QString PlaceholderMasker::restoreAccelerator(const QString &translated, QChar accelerator) {
+    if (accelerator.isNull()) {
+        return translated;
+    }
+
+    // 译文中有相同字母时直接标在该字母前
+    if (accelerator.isLetter()) {
+        int pos = translated.indexOf(accelerator, 0, Qt::CaseInsensitive);
+        if (pos >= 0) {
+            QString result = translated;
+            result.insert(pos, '&');
+            return result;
+        }
+    }
+
+    // 否则按中日韩习惯追加 (&X)，放在末尾的省略号或冒号之前
+    int end = translated.size();
+    while (end > 0) {
+        QChar c = translated.at(end - 1);
+        if (c == '.' || c == QChar(0x2026) || c == ':' || c == QChar(0xFF1A) || c.isSpace()) {
+            --end;
+        } else {
+            break;
+        }
+    }
+    QString result = translated;
+    result.insert(end, QString("(&%1)").arg(accelerator.toUpper()));
+    return result;
+}
@@ -0,0 +1,82 @@
+#include "progressaggregator.h"
+
+#include <utility>
+
+ProgressAggregator::ProgressAggregator(QObject *parent)
+    : QObject(parent) {
+    m_frameTimer.setSingleShot(true);
+    m_frameTimer.setInterval(16);
+    connect(&m_frameTimer, &QTimer::timeout, this, &ProgressAggregator::emitProgress);
+}
+
+void ProgressAggregator::report(quint64 jobId, int current, int total) {
+    if (m_jobs.isEmpty()) {
+        m_clock.start();
+    }
+
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end()) {
+        JobProgress job;
+        job.startValue = current;
+        it = m_jobs.insert(jobId, job);
+    }
+    it->current = current;
+    it->total = total;
+
+    if (!m_frameTimer.isActive()) {
+        m_frameTimer.start();
+    }
+}
+
+void ProgressAggregator::finishJob(quint64 jobId) {
+    auto it = m_jobs.find(jobId);
+    if (it == m_jobs.end()) {
+        return;
+    }
+    it->current = it->total;
+    it->finished = true;
+    clearIfFinished();
+    if (!m_jobs.isEmpty() && !m_frameTimer.isActive()) {
+        m_frameTimer.start();
+    }
+}
+
+void ProgressAggregator::cancelJob(quint64 jobId) {
+    if (m_jobs.remove(jobId) == 0) {
+        return;
+    }
+    clearIfFinished();
+    if (!m_jobs.isEmpty() && !m_frameTimer.isActive()) {
+        m_frameTimer.start();
+    }
+}
+
+void ProgressAggregator::clearIfFinished() {
+    for (const JobProgress &job : std::as_const(m_jobs)) {
+        if (!job.finished) {
+            return;
+        }
+    }
+    if (!m_jobs.isEmpty()) {
+        m_frameTimer.stop();
+        emitProgress();
+    }
+    m_jobs.clear();
+}
+
+void ProgressAggregator::emitProgress() {
+    int done = 0;
+    int total = 0;
+    int doneSinceStart = 0;
+    for (const JobProgress &job : std::as_const(m_jobs)) {
+        done += job.current;
+        total += job.total;
+        doneSinceStart += job.current - job.startValue;
+    }
+
+    double seconds = m_clock.isValid() ? m_clock.elapsed() / 1000.0 : 0;
+    double itemsPerSecond = seconds > 0 ? doneSinceStart / seconds : 0;
+    qint64 etaMs = itemsPerSecond > 0 ? static_cast<qint64>((total - done) / itemsPerSecond * 1000) : -1;
+
+    emit progressChanged(done, total, itemsPerSecond, etaMs);
+}
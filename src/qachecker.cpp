@@ -0,0 +1,398 @@
+#include "qachecker.h"
+
+#include <QRegularExpression>
+#include <QRunnable>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include "placeholdermasker.h"
+#include "tracerecorder.h"
+
+namespace {
+
+// 少于该数量的条目直接在当前线程检查
+const int ParallelThreshold = 2048;
+
+const QRegularExpression &placeholderPattern() {
+    static const QRegularExpression pattern(
+        "%L?(?:\\d{1,2}|n)(?!\\$)"
+        "|%(?:\\d+\\$)?[-+#0]*\\d*(?:\\.\\d+)?(?:hh|h|ll|l)?[diouxXeEfgGcsp]");
+    return pattern;
+}
+
+const QRegularExpression &tagPattern() {
+    static const QRegularExpression pattern("<(/?)([A-Za-z][A-Za-z0-9]*)[^<>]*?(/?)>");
+    return pattern;
+}
+
+QStringList placeholders(const QString &text) {
+    QStringList result;
+    QRegularExpressionMatchIterator it = placeholderPattern().globalMatch(text);
+    while (it.hasNext()) {
+        result.append(it.next().captured());
+    }
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+// 返回规范化后的标签序列（只保留名称与开闭），balanced 表示开闭标签是否配对
+QStringList tags(const QString &text, bool &balanced) {
+    static const QStringList voidElements = {"br", "hr", "img", "input", "meta", "link"};
+    QStringList result;
+    QStringList open;
+    balanced = true;
+    QRegularExpressionMatchIterator it = tagPattern().globalMatch(text);
+    while (it.hasNext()) {
+        QRegularExpressionMatch match = it.next();
+        const bool closing = !match.captured(1).isEmpty();
+        const QString name = match.captured(2).toLower();
+        result.append(closing ? "/" + name : name);
+        if (!match.captured(3).isEmpty() || voidElements.contains(name)) {
+            continue;
+        }
+        if (!closing) {
+            open.append(name);
+        } else if (!open.isEmpty() && open.last() == name) {
+            open.removeLast();
+        } else {
+            balanced = false;
+        }
+    }
+    balanced = balanced && open.isEmpty();
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+QStringList difference(const QStringList &from, const QStringList &remove) {
+    QStringList result = from;
+    for (const QString &item : remove) {
+        result.removeOne(item);
+    }
+    return result;
+}
+
+void checkRange(const EntryStore::Snapshot &entries, const QVector<int> &indices, int begin, int end,
+                QMap<int, QList<QaChecker::Issue>> &result) {
+    for (int i = begin; i < end; ++i) {
+        int index = indices.at(i);
+        QList<QaChecker::Issue> issues = QaChecker::checkEntry(index, entries.at(index));
+        if (!issues.isEmpty()) {
+            result.insert(index, issues);
+        }
+    }
+}
+
+// 一次并行检查：各块写入独立的结果，最后完成的块合并后交给 finished
+struct CheckJob {
+    EntryStore::Snapshot entries;
+    QVector<int> indices;
+    QVector<QMap<int, QList<QaChecker::Issue>>> partial;
+    std::atomic<int> remaining{0};
+    std::function<void(const QMap<int, QList<QaChecker::Issue>> &)> finished;
+};
+
+class CheckTask : public QRunnable {
+public:
+    CheckTask(const std::shared_ptr<CheckJob> &job, int begin, int end,
+              QMap<int, QList<QaChecker::Issue>> *result)
+        : m_job(job), m_begin(begin), m_end(end), m_result(result) {}
+
+    void run() override {
+        checkRange(m_job->entries, m_job->indices, m_begin, m_end, *m_result);
+        if (m_job->remaining.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        QMap<int, QList<QaChecker::Issue>> result;
+        for (const auto &chunk : std::as_const(m_job->partial)) {
+            for (auto it = chunk.constBegin(); it != chunk.constEnd(); ++it) {
+                result.insert(it.key(), it.value());
+            }
+        }
+        m_job->finished(result);
+    }
+
+private:
+    std::shared_ptr<CheckJob> m_job;
+    int m_begin;
+    int m_end;
+    QMap<int, QList<QaChecker::Issue>> *m_result;
+};
+
+} // namespace
+
+QaChecker::QaChecker(TsFileHandler *fileHandler, QObject *parent)
+    : QObject(parent), m_fileHandler(fileHandler) {
+    // 批量翻译会连续更新大量条目，合并到一次重新检查
+    m_recheckTimer.setSingleShot(true);
+    m_recheckTimer.setInterval(100);
+    connect(&m_recheckTimer, &QTimer::timeout, this, &QaChecker::recheckPending);
+
+    connect(m_fileHandler, &TsFileHandler::fileLoaded, this, &QaChecker::onEntriesReset);
+    connect(m_fileHandler, &TsFileHandler::entriesReset, this, &QaChecker::onEntriesReset);
+    connect(m_fileHandler, &TsFileHandler::entryUpdated, this, &QaChecker::onEntryChanged);
+    connect(m_fileHandler, &TsFileHandler::entriesUpdated, this, &QaChecker::onEntriesChanged);
+    connect(m_fileHandler, &TsFileHandler::entryAdded, this, &QaChecker::onEntryChanged);
+    connect(m_fileHandler, &TsFileHandler::entriesRemoved, this, &QaChecker::onEntriesRemoved);
+}
+
+QaChecker::~QaChecker() {
+    // 丢弃未开始的块并等待进行中的块结束，之后投递回来的结果随对象一起销毁
+    m_pool.clear();
+    m_pool.waitForDone();
+}
+
+QString QaChecker::ruleName(Rule rule) {
+    switch (rule) {
+        case PlaceholderMismatch: return "占位符不一致";
+        case AcceleratorLost: return "快捷键丢失";
+        case TagMismatch: return "标签不一致";
+        case UntranslatedCopy: return "未翻译";
+        case LengthRatio: return "长度异常";
+    }
+    return "未知";
+}
+
+QList<QaChecker::Issue> QaChecker::checkEntry(int index, const TsEntry &entry) {
+    QList<Issue> issues;
+    if (entry.translation.isEmpty() || entry.state == TranslationState::Obsolete
+        || entry.state == TranslationState::Vanished) {
+        return issues;
+    }
+    const QString &source = entry.source;
+    const QString &translation = entry.translation;
+
+    const QStringList sourcePlaceholders = placeholders(source);
+    const QStringList translationPlaceholders = placeholders(translation);
+    if (sourcePlaceholders != translationPlaceholders) {
+        QStringList missing = difference(sourcePlaceholders, translationPlaceholders);
+        QStringList extra = difference(translationPlaceholders, sourcePlaceholders);
+        QString message = missing.isEmpty() ? QString() : "缺少 " + missing.join(" ");
+        if (!extra.isEmpty()) {
+            message += (message.isEmpty() ? "" : "，") + QString("多出 ") + extra.join(" ");
+        }
+        issues.append({index, PlaceholderMismatch, message});
+    }
+
+    const QChar accelerator = PlaceholderMasker::mask(source).accelerator;
+    if (!accelerator.isNull() && PlaceholderMasker::mask(translation).accelerator.isNull()) {
+        issues.append({index, AcceleratorLost, QString("原文快捷键 &%1").arg(accelerator)});
+    }
+
+    bool sourceBalanced = true;
+    bool translationBalanced = true;
+    const QStringList sourceTags = tags(source, sourceBalanced);
+    const QStringList translationTags = tags(translation, translationBalanced);
+    if (sourceTags != translationTags) {
+        QStringList changed = difference(sourceTags, translationTags) + difference(translationTags, sourceTags);
+        issues.append({index, TagMismatch, "标签与原文不同: " + changed.join(" ")});
+    } else if (sourceBalanced && !translationBalanced) {
+        issues.append({index, TagMismatch, "标签顺序不配对"});
+    }
+
+    // 只有占位符或数字的原文允许原样保留
+    if (translation == source && PlaceholderMasker::mask(source).needsTranslation) {
+        issues.append({index, UntranslatedCopy, "译文与原文相同"});
+    }
+
+    // 短文本的比例没有意义；中日韩译文通常比英文短，下限放宽
+    if (source.size() >= 8) {
+        const double ratio = double(translation.size()) / source.size();
+        if (ratio > 4.0 || ratio < 0.15) {
+            issues.append({index, LengthRatio, QString("译文长度为原文的 %1 倍").arg(ratio, 0, 'f', 2)});
+        }
+    }
+    return issues;
+}
+
+QList<QaChecker::Issue> QaChecker::issues() const {
+    QList<Issue> result;
+    result.reserve(m_issueCount);
+    for (auto it = m_issues.constBegin(); it != m_issues.constEnd(); ++it) {
+        result.append(it.value());
+    }
+    return result;
+}
+
+void QaChecker::startCheck(const QVector<int> &indices, bool all) {
+    const quint64 generation = ++m_generation;
+    m_pool.clear();
+    m_checkingAll = all;
+    m_checkingIndices = all ? QVector<int>() : indices;
+
+    // 工作线程只读取快照，检查期间 GUI 线程的修改不会影响结果
+    const EntryStore::Snapshot entries = m_fileHandler->snapshot();
+    if (indices.size() < ParallelThreshold) {
+        QMap<int, QList<Issue>> result;
+        checkRange(entries, indices, 0, indices.size(), result);
+        finishCheck(indices, all, result);
+        return;
+    }
+
+    auto job = std::make_shared<CheckJob>();
+    job->entries = entries;
+    job->indices = indices;
+    job->finished = [this, generation, indices, all](const QMap<int, QList<Issue>> &result) {
+        QMetaObject::invokeMethod(this, [this, generation, indices, all, result] {
+            if (generation == m_generation) {
+                finishCheck(indices, all, result);
+            }
+        }, Qt::QueuedConnection);
+    };
+
+    // 每个线程处理若干块；结果指针在启动任何任务之前取得
+    const int chunks = qMax(1, m_pool.maxThreadCount() * 4);
+    const int chunkSize = (indices.size() + chunks - 1) / chunks;
+    job->partial.resize(chunks);
+    QVector<CheckTask *> tasks;
+    for (int chunk = 0; chunk < chunks; ++chunk) {
+        int begin = chunk * chunkSize;
+        int end = qMin(indices.size(), begin + chunkSize);
+        if (begin < end) {
+            tasks.append(new CheckTask(job, begin, end, &job->partial[chunk]));
+        }
+    }
+    job->remaining = tasks.size();
+    setChecking(true);
+    for (CheckTask *task : std::as_const(tasks)) {
+        m_pool.start(task);
+    }
+}
+
+void QaChecker::finishCheck(const QVector<int> &indices, bool all, const QMap<int, QList<Issue>> &result) {
+    TraceScope trace("QaChecker::finishCheck", "qa");
+    m_checkingIndices.clear();
+    if (all) {
+        m_issues = result;
+        m_issueCount = 0;
+        for (const QList<Issue> &issues : std::as_const(m_issues)) {
+            m_issueCount += issues.size();
+        }
+    } else {
+        for (int index : indices) {
+            m_issueCount -= m_issues.value(index).size();
+            QList<Issue> issues = result.value(index);
+            if (issues.isEmpty()) {
+                m_issues.remove(index);
+            } else {
+                m_issueCount += issues.size();
+                m_issues.insert(index, issues);
+            }
+        }
+    }
+    setChecking(false);
+    emit issuesChanged();
+
+    // 检查期间修改的条目按快照检查过，再检查一次
+    if (!m_pending.isEmpty() && !m_recheckTimer.isActive()) {
+        m_recheckTimer.start();
+    }
+}
+
+void QaChecker::setChecking(bool checking) {
+    if (m_checking != checking) {
+        m_checking = checking;
+        emit checkingChanged(checking);
+    }
+}
+
+void QaChecker::checkAll() {
+    TraceScope trace("QaChecker::checkAll", "qa");
+    m_recheckTimer.stop();
+    m_pending.clear();
+
+    QVector<int> indices(m_fileHandler->entries().size());
+    std::iota(indices.begin(), indices.end(), 0);
+    startCheck(indices, true);
+}
+
+void QaChecker::onEntriesReset() {
+    // 旧问题的下标已失效，检查完成前不再显示
+    m_issues.clear();
+    m_issueCount = 0;
+    emit issuesChanged();
+    checkAll();
+}
+
+void QaChecker::onEntryChanged(int index) {
+    m_pending.insert(index);
+    if (!m_recheckTimer.isActive()) {
+        m_recheckTimer.start();
+    }
+}
+
+void QaChecker::onEntriesChanged(int first, int last) {
+    for (int index = first; index <= last; ++index) {
+        m_pending.insert(index);
+    }
+    if (!m_recheckTimer.isActive()) {
+        m_recheckTimer.start();
+    }
+}
+
+void QaChecker::onEntriesRemoved(const QVector<int> &indices) {
+    // 一次遍历换成删除后的下标，被删条目的问题一并移除
+    QMap<int, QList<Issue>> shifted;
+    for (auto it = m_issues.begin(); it != m_issues.end(); ++it) {
+        const int entry = TsFileHandler::remapIndex(indices, it.key());
+        if (entry < 0) {
+            m_issueCount -= it.value().size();
+            continue;
+        }
+        for (Issue &issue : it.value()) {
+            issue.entry = entry;
+        }
+        shifted.insert(shifted.cend(), entry, it.value());
+    }
+    m_issues = shifted;
+
+    QSet<int> pending;
+    for (int entry : std::as_const(m_pending)) {
+        const int remapped = TsFileHandler::remapIndex(indices, entry);
+        if (remapped >= 0) {
+            pending.insert(remapped);
+        }
+    }
+    m_pending = pending;
+
+    // 进行中的检查按旧下标返回结果，作废后重新检查
+    if (m_checking) {
+        ++m_generation;
+        m_pool.clear();
+        setChecking(false);
+        if (m_checkingAll) {
+            emit issuesChanged();
+            checkAll();
+            return;
+        }
+        for (int entry : std::as_const(m_checkingIndices)) {
+            const int remapped = TsFileHandler::remapIndex(indices, entry);
+            if (remapped >= 0) {
+                m_pending.insert(remapped);
+            }
+        }
+        m_checkingIndices.clear();
+    }
+    if (!m_pending.isEmpty() && !m_recheckTimer.isActive()) {
+        m_recheckTimer.start();
+    }
+    emit issuesChanged();
+}
+
+void QaChecker::recheckPending() {
+    if (m_checking) {
+        return;     // 当前检查完成后再处理
+    }
+    TraceScope trace("QaChecker::recheckPending", "qa");
+    const int count = m_fileHandler->entries().size();
+    QVector<int> indices;
+    indices.reserve(m_pending.size());
+    for (int index : std::as_const(m_pending)) {
+        if (index >= 0 && index < count) {
+            indices.append(index);
+        }
+    }
+    m_pending.clear();
+    startCheck(indices, false);
+}
@@ -0,0 +1,63 @@
+#include "qaissuemodel.h"
+
+QaIssueModel::QaIssueModel(TsFileHandler *fileHandler, QObject *parent)
+    : QAbstractTableModel(parent), m_fileHandler(fileHandler) {}
+
+int QaIssueModel::rowCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : m_issues.size();
+}
+
+int QaIssueModel::columnCount(const QModelIndex &parent) const {
+    return parent.isValid() ? 0 : ColumnCount;
+}
+
+QVariant QaIssueModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid() || index.row() >= m_issues.size()) {
+        return QVariant();
+    }
+    const QaChecker::Issue &issue = m_issues.at(index.row());
+    if (role == Qt::UserRole) {
+        return issue.entry;
+    }
+    if (role != Qt::DisplayRole && role != Qt::ToolTipRole) {
+        return QVariant();
+    }
+
+    switch (index.column()) {
+        case RuleColumn:
+            return QaChecker::ruleName(issue.rule);
+        case MessageColumn:
+            return issue.message;
+        default:
+            break;
+    }
+    const EntryStore &entries = m_fileHandler->entries();
+    if (issue.entry < 0 || issue.entry >= entries.size()) {
+        return QVariant();
+    }
+    const TsEntry &entry = entries.at(issue.entry);
+    return index.column() == ContextColumn ? entry.context : entry.source;
+}
+
+QVariant QaIssueModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+        case ContextColumn: return "上下文";
+        case SourceColumn: return "源文本";
+        case RuleColumn: return "规则";
+        case MessageColumn: return "问题";
+        default: return QVariant();
+    }
+}
+
+void QaIssueModel::setIssues(const QList<QaChecker::Issue> &issues) {
+    beginResetModel();
+    m_issues = issues;
+    endResetModel();
+}
+
+int QaIssueModel::entryAt(int row) const {
+    return row >= 0 && row < m_issues.size() ? m_issues.at(row).entry : -1;
+}
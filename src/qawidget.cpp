@@ -0,0 +1,105 @@
+#include "qawidget.h"
+
+#include <QHBoxLayout>
+#include <QHeaderView>
+#include <QVBoxLayout>
+
+QaWidget::QaWidget(QaChecker *checker, TsFileHandler *fileHandler, QWidget *parent)
+    : QWidget(parent), m_checker(checker), m_fileHandler(fileHandler) {
+
+    m_ruleCombo = new QComboBox(this);
+    m_ruleCombo->addItem("全部规则", -1);
+    for (QaChecker::Rule rule : {QaChecker::PlaceholderMismatch, QaChecker::AcceleratorLost,
+                                 QaChecker::TagMismatch, QaChecker::UntranslatedCopy,
+                                 QaChecker::LengthRatio}) {
+        m_ruleCombo->addItem(QaChecker::ruleName(rule), int(rule));
+    }
+
+    m_filterEdit = new QLineEdit(this);
+    m_filterEdit->setPlaceholderText("筛选上下文或源文本");
+    m_filterEdit->setClearButtonEnabled(true);
+
+    m_checkButton = new QPushButton("全部检查", this);
+    m_countLabel = new QLabel(this);
+
+    m_model = new QaIssueModel(m_fileHandler, this);
+    m_table = new QTableView(this);
+    m_table->setModel(m_model);
+    m_table->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    m_table->setSelectionBehavior(QAbstractItemView::SelectRows);
+    m_table->setSelectionMode(QAbstractItemView::SingleSelection);
+    m_table->verticalHeader()->setVisible(false);
+    m_table->horizontalHeader()->setSectionResizeMode(QHeaderView::Interactive);
+    m_table->horizontalHeader()->setStretchLastSection(true);
+
+    QHBoxLayout *filterLayout = new QHBoxLayout;
+    filterLayout->addWidget(m_ruleCombo);
+    filterLayout->addWidget(m_filterEdit, 1);
+    filterLayout->addWidget(m_countLabel);
+    filterLayout->addWidget(m_checkButton);
+
+    QVBoxLayout *layout = new QVBoxLayout(this);
+    layout->addLayout(filterLayout);
+    layout->addWidget(m_table);
+    setLayout(layout);
+
+    // 编辑过程中问题列表会频繁变化，合并刷新且仅在面板可见时刷新
+    m_refreshTimer.setSingleShot(true);
+    m_refreshTimer.setInterval(200);
+    connect(&m_refreshTimer, &QTimer::timeout, this, &QaWidget::refresh);
+    connect(m_checker, &QaChecker::issuesChanged, this, &QaWidget::scheduleRefresh);
+    connect(m_ruleCombo, QOverload<int>::of(&QComboBox::currentIndexChanged), this, &QaWidget::refresh);
+    connect(m_filterEdit, &QLineEdit::textChanged, this, &QaWidget::scheduleRefresh);
+    connect(m_checkButton, &QPushButton::clicked, m_checker, &QaChecker::checkAll);
+    connect(m_table, &QTableView::activated, [this](const QModelIndex &index){
+        const int entry = m_model->entryAt(index.row());
+        if (entry >= 0) {
+            emit entryActivated(entry);
+        }
+    });
+    // 条目较多时检查在后台进行，完成前不能再次发起
+    connect(m_checker, &QaChecker::checkingChanged, [this](bool checking){
+        m_checkButton->setEnabled(!checking);
+        m_checkButton->setText(checking ? "检查中..." : "全部检查");
+    });
+}
+
+void QaWidget::refresh() {
+    if (!isVisible()) {
+        return;
+    }
+    const int rule = m_ruleCombo->currentData().toInt();
+    const QString filter = m_filterEdit->text();
+    const EntryStore &entries = m_fileHandler->entries();
+
+    QList<QaChecker::Issue> shown;
+    for (const QaChecker::Issue &issue : m_checker->issues()) {
+        if (rule >= 0 && issue.rule != rule) {
+            continue;
+        }
+        if (issue.entry >= entries.size()) {
+            continue;
+        }
+        const TsEntry &entry = entries.at(issue.entry);
+        if (!filter.isEmpty() && !entry.context.contains(filter, Qt::CaseInsensitive)
+            && !entry.source.contains(filter, Qt::CaseInsensitive)) {
+            continue;
+        }
+        shown.append(issue);
+    }
+
+    m_model->setIssues(shown);
+
+    m_countLabel->setText(QString("%1 / %2 个问题").arg(shown.size()).arg(m_checker->issueCount()));
+}
+
+void QaWidget::scheduleRefresh() {
+    if (isVisible() && !m_refreshTimer.isActive()) {
+        m_refreshTimer.start();
+    }
+}
+
+void QaWidget::showEvent(QShowEvent *event) {
+    QWidget::showEvent(event);
+    refresh();
+}
@@ -0,0 +1,286 @@
+#include "qmwriter.h"
+
+#include <QDataStream>
+#include <QFileInfo>
+#include <QLocale>
+#include <QMap>
+#include <QRunnable>
+#include <QSaveFile>
+#include <QSet>
+#include <QThreadPool>
+#include <QVector>
+#include <algorithm>
+#include <tuple>
+#include "tracerecorder.h"
+
+namespace {
+
+const uchar Magic[16] = {
+    0x3c, 0xb8, 0x64, 0x18, 0xca, 0xef, 0x9c, 0x95,
+    0xcd, 0x21, 0x1c, 0xbf, 0x60, 0xa1, 0xbd, 0xdd
+};
+
+// 文件段标签
+enum Section {
+    Contexts = 0x2f,
+    Hashes = 0x42,
+    Messages = 0x69,
+    NumerusRules = 0x88,
+    Dependencies = 0x96,
+    Language = 0xa7
+};
+
+// 消息块内的字段标签
+enum Tag {
+    Tag_End = 1,
+    Tag_Translation = 3,
+    Tag_SourceText = 6,
+    Tag_Context = 7,
+    Tag_Comment = 8
+};
+
+// 复数规则字节码
+enum NumerusOp {
+    Q_EQ = 0x01,
+    Q_LT = 0x02,
+    Q_LEQ = 0x03,
+    Q_BETWEEN = 0x04,
+    Q_NOT = 0x08,
+    Q_MOD_10 = 0x10,
+    Q_MOD_100 = 0x20,
+    Q_AND = 0xfd,
+    Q_NEWRULE = 0xff,
+
+    Q_NEQ = Q_NOT | Q_EQ,
+    Q_GEQ = Q_NOT | Q_LT,
+    Q_NOT_BETWEEN = Q_NOT | Q_BETWEEN
+};
+
+// QTranslator 的查找顺序：(上下文, 源文本, 注释) 按字节比较
+struct MessageKey {
+    QByteArray context;
+    QByteArray source;
+    QByteArray comment;
+
+    bool operator<(const MessageKey &other) const {
+        return std::tie(context, source, comment) < std::tie(other.context, other.source, other.comment);
+    }
+};
+
+// 空字符串也写成长度为 0 的字节串，而不是空值标记
+QByteArray originalBytes(const QString &text) {
+    return text.isEmpty() ? QByteArray("") : text.toUtf8();
+}
+
+// 与 QTranslator 查找时使用的 ELF 哈希一致
+quint32 elfHash(const QByteArray &data) {
+    const uchar *k = reinterpret_cast<const uchar *>(data.constData());
+    quint32 h = 0;
+    while (*k) {
+        h = (h << 4) + *k++;
+        quint32 g = h & 0xf0000000;
+        if (g != 0) {
+            h ^= g >> 24;
+        }
+        h &= ~g;
+    }
+    return h ? h : 1;
+}
+
+void writeSection(QDataStream &stream, Section section, const QByteArray &data) {
+    stream << quint8(section) << quint32(data.size());
+    stream.writeRawData(data.constData(), data.size());
+}
+
+class ReleaseTask : public QRunnable {
+public:
+    ReleaseTask(const QString &tsPath, bool *result) : m_tsPath(tsPath), m_result(result) {}
+
+    void run() override {
+        TsFileHandler handler;
+        *m_result = handler.load(m_tsPath) && handler.release(QmWriter::qmPath(m_tsPath));
+    }
+
+private:
+    QString m_tsPath;
+    bool *m_result;
+};
+
+} // namespace
+
+QByteArray QmWriter::compile(const QString &language, const EntryStore::Snapshot &entries) {
+    TraceScope trace("QmWriter::compile", "io");
+
+    // (上下文, 源文本) 已有不带注释的条目时，带注释的条目必须保留注释才能区分
+    QSet<QPair<QString, QString>> uncommented;
+    for (const TsEntry &entry : entries) {
+        if (entry.comments.value(0).isEmpty()) {
+            uncommented.insert(qMakePair(entry.context, entry.source));
+        }
+    }
+
+    // 相同键只保留第一条；注释唯一时省略注释，QTranslator 查找失败后会以空注释重试
+    QMap<MessageKey, QString> messages;
+    for (const TsEntry &entry : entries) {
+        if (entry.state == TranslationState::Obsolete || entry.state == TranslationState::Vanished) {
+            continue;
+        }
+        if (entry.state == TranslationState::Unfinished && entry.translation.isEmpty()) {
+            continue;
+        }
+
+        const QString comment = entry.comments.value(0);
+        MessageKey key{originalBytes(entry.context), originalBytes(entry.source), originalBytes(comment)};
+        bool forceComment = comment.isEmpty() || entry.context.isEmpty()
+                            || uncommented.contains(qMakePair(entry.context, entry.source));
+        if (!forceComment) {
+            MessageKey stripped{key.context, key.source, QByteArray("")};
+            if (!messages.contains(stripped)) {
+                messages.insert(stripped, entry.translation);
+                continue;
+            }
+        }
+        if (!messages.contains(key)) {
+            messages.insert(key, entry.translation);
+        }
+    }
+
+    // 消息块按键排序写出，哈希表按 (哈希, 偏移) 排序供 QTranslator 二分查找
+    QByteArray messageArray;
+    QVector<QPair<quint32, quint32>> offsets;
+    offsets.reserve(messages.size());
+    {
+        QDataStream stream(&messageArray, QIODevice::WriteOnly);
+        for (auto it = messages.constBegin(); it != messages.constEnd(); ++it) {
+            const MessageKey &key = it.key();
+            offsets.append(qMakePair(elfHash(key.source + key.comment), quint32(messageArray.size())));
+            // 空译文写成空值，QTranslator 会回退到源文本
+            stream << quint8(Tag_Translation) << (it.value().isEmpty() ? QString() : it.value());
+            stream << quint8(Tag_Comment) << key.comment;
+            stream << quint8(Tag_SourceText) << key.source;
+            stream << quint8(Tag_Context) << key.context;
+            stream << quint8(Tag_End);
+        }
+    }
+    std::sort(offsets.begin(), offsets.end());
+
+    QByteArray offsetArray;
+    {
+        QDataStream stream(&offsetArray, QIODevice::WriteOnly);
+        for (const auto &offset : std::as_const(offsets)) {
+            stream << offset.first << offset.second;
+        }
+    }
+
+    QByteArray qm;
+    QDataStream stream(&qm, QIODevice::WriteOnly);
+    stream.writeRawData(reinterpret_cast<const char *>(Magic), sizeof(Magic));
+    if (!language.isEmpty()) {
+        writeSection(stream, Language, language.toUtf8());
+    }
+    if (!offsetArray.isEmpty()) {
+        writeSection(stream, Hashes, offsetArray);
+    }
+    if (!messageArray.isEmpty()) {
+        writeSection(stream, Messages, messageArray);
+    }
+    const QByteArray rules = numerusRules(language);
+    if (!rules.isEmpty()) {
+        writeSection(stream, NumerusRules, rules);
+    }
+    return qm;
+}
+
+bool QmWriter::write(const QString &qmPath, const QString &language, const EntryStore::Snapshot &entries) {
+    const QByteArray qm = compile(language, entries);
+    QSaveFile file(qmPath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(qm);
+    return file.commit();
+}
+
+QString QmWriter::qmPath(const QString &tsPath) {
+    QFileInfo info(tsPath);
+    return info.path() + "/" + info.completeBaseName() + ".qm";
+}
+
+QStringList QmWriter::releaseFiles(const QStringList &tsFiles) {
+    TraceScope trace("QmWriter::releaseFiles", "io");
+    QVector<bool> results(tsFiles.size(), false);
+
+    // 每个文件独立加载、编译与写出，互不共享状态
+    QThreadPool pool;
+    for (int i = 0; i < tsFiles.size(); ++i) {
+        pool.start(new ReleaseTask(tsFiles.at(i), &results[i]));
+    }
+    pool.waitForDone();
+
+    QStringList failed;
+    for (int i = 0; i < tsFiles.size(); ++i) {
+        if (!results.at(i)) {
+            failed.append(tsFiles.at(i));
+        }
+    }
+    return failed;
+}
+
+QByteArray QmWriter::numerusRules(const QString &language) {
+    static const uchar englishStyleRules[] = {Q_EQ, 1};
+    static const uchar frenchStyleRules[] = {Q_LEQ, 1};
+    static const uchar czechRules[] = {Q_EQ, 1, Q_NEWRULE,
+                                       Q_BETWEEN, 2, 4};
+    static const uchar polishRules[] = {Q_EQ, 1, Q_NEWRULE,
+                                        Q_MOD_10 | Q_BETWEEN, 2, 4, Q_AND, Q_MOD_100 | Q_NOT_BETWEEN, 10, 20};
+    static const uchar slavicRules[] = {Q_MOD_10 | Q_EQ, 1, Q_AND, Q_MOD_100 | Q_NEQ, 11, Q_NEWRULE,
+                                        Q_MOD_10 | Q_BETWEEN, 2, 4, Q_AND, Q_MOD_100 | Q_NOT_BETWEEN, 10, 20};
+    static const uchar arabicRules[] = {Q_EQ, 0, Q_NEWRULE,
+                                        Q_EQ, 1, Q_NEWRULE,
+                                        Q_EQ, 2, Q_NEWRULE,
+                                        Q_MOD_100 | Q_BETWEEN, 3, 10, Q_NEWRULE,
+                                        Q_MOD_100 | Q_GEQ, 11};
+
+#define RULES(rules) QByteArray(reinterpret_cast<const char *>(rules), sizeof(rules))
+    // 巴西葡萄牙语与法语同类，其他葡萄牙语与英语同类
+    if (language.startsWith("pt_BR") || language.startsWith("pt-BR")) {
+        return RULES(frenchStyleRules);
+    }
+
+    switch (QLocale(language).language()) {
+        case QLocale::English:
+        case QLocale::German:
+        case QLocale::Spanish:
+        case QLocale::Italian:
+        case QLocale::Portuguese:
+        case QLocale::Dutch:
+        case QLocale::Swedish:
+        case QLocale::Danish:
+        case QLocale::NorwegianBokmal:
+        case QLocale::Finnish:
+        case QLocale::Greek:
+        case QLocale::Estonian:
+        case QLocale::Bulgarian:
+        case QLocale::Catalan:
+            return RULES(englishStyleRules);
+        case QLocale::French:
+            return RULES(frenchStyleRules);
+        case QLocale::Czech:
+        case QLocale::Slovak:
+            return RULES(czechRules);
+        case QLocale::Polish:
+            return RULES(polishRules);
+        case QLocale::Russian:
+        case QLocale::Ukrainian:
+        case QLocale::Serbian:
+        case QLocale::Croatian:
+        case QLocale::Bosnian:
+            return RULES(slavicRules);
+        case QLocale::Arabic:
+            return RULES(arabicRules);
+        default:
+            // 中文、日语、韩语等没有复数形式，lrelease 同样不写规则
+            return QByteArray();
+    }
+#undef RULES
+}
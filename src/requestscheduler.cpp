@@ -0,0 +1,155 @@
+#include "requestscheduler.h"
+
+#include <QCoreApplication>
+#include <QSettings>
+#include "translationmetrics.h"
+
+namespace {
+
+QString quotaKey(TranslationService::Engine engine) {
+    return QString("Translation/%1/remainingQuota").arg(static_cast<int>(engine));
+}
+
+} // namespace
+
+RequestScheduler *RequestScheduler::instance() {
+    static RequestScheduler scheduler;
+    return &scheduler;
+}
+
+RequestScheduler::RequestScheduler(QObject *parent) : QObject(parent) {
+    QSettings settings;
+    for (TranslationService::Engine engine : TranslationService::supportedEngines()) {
+        m_quotas.insert(engine, settings.value(quotaKey(engine), -1).toLongLong());
+    }
+
+    // 批量翻译每秒派发多个请求，额度合并到每 5 秒最多写一次设置
+    m_quotaTimer.setSingleShot(true);
+    m_quotaTimer.setInterval(5000);
+    connect(&m_quotaTimer, &QTimer::timeout, this, &RequestScheduler::flushQuota);
+    if (QCoreApplication::instance()) {
+        connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, this, &RequestScheduler::flushQuota);
+    }
+}
+
+qint64 RequestScheduler::remainingQuota(TranslationService::Engine engine) const {
+    return m_quotas.value(engine, -1);
+}
+
+void RequestScheduler::setRemainingQuota(TranslationService::Engine engine, qint64 characters) {
+    m_quotas.insert(engine, characters);
+    // 用户修改的额度立即写入
+    m_quotaDirty = true;
+    flushQuota();
+}
+
+void RequestScheduler::consumeQuota(TranslationService::Engine engine, qint64 characters) {
+    const qint64 quota = remainingQuota(engine);
+    if (quota < 0 || characters == 0) {
+        return;
+    }
+    m_quotas.insert(engine, qMax<qint64>(0, quota - characters));
+    m_quotaDirty = true;
+    if (!m_quotaTimer.isActive()) {
+        m_quotaTimer.start();
+    }
+}
+
+void RequestScheduler::flushQuota() {
+    m_quotaTimer.stop();
+    if (!m_quotaDirty) {
+        return;
+    }
+    m_quotaDirty = false;
+    QSettings settings;
+    for (auto it = m_quotas.cbegin(); it != m_quotas.cend(); ++it) {
+        settings.setValue(quotaKey(it.key()), it.value());
+    }
+}
+
+qint64 RequestScheduler::intervalUs(TranslationService::Engine engine, Lane lane) {
+    // 百度与有道限制每秒一次请求：交互通道按限制发送，其余通道只用约四分之三的额度，
+    // 预取只用一半；其他引擎仅为批量与预取保留 100ms 的间隔
+    qint64 limit = 0;
+    switch (engine) {
+        case TranslationService::BaiduTranslate:
+        case TranslationService::YoudaoTranslate:
+            limit = 1000000;
+            break;
+        case TranslationService::GoogleTranslate:
+        case TranslationService::DeepLTranslate:
+            break;
+    }
+    switch (lane) {
+        case Interactive:
+            return limit;
+        case Visible:
+        case Background:
+            return qMax<qint64>(100000, limit * 4 / 3);
+        case Prefetch:
+        case LaneCount:
+            break;
+    }
+    return qMax<qint64>(100000, limit * 2);
+}
+
+void RequestScheduler::submit(TranslationService::Engine engine, Lane lane, QObject *owner,
+                              std::function<void()> send) {
+    m_engines[engine].lanes[lane].append({owner, std::move(send)});
+    pump(engine);
+}
+
+void RequestScheduler::cancel(QObject *owner, Lane lane) {
+    for (EngineQueue &queue : m_engines) {
+        QList<Job> &jobs = queue.lanes[lane];
+        for (int i = jobs.size() - 1; i >= 0; --i) {
+            if (jobs.at(i).owner == owner) {
+                jobs.removeAt(i);
+            }
+        }
+    }
+}
+
+void RequestScheduler::pump(TranslationService::Engine engine) {
+    EngineQueue &queue = m_engines[engine];
+    if (queue.pumping) {
+        return;     // send 中再次提交的请求由外层循环放行
+    }
+    queue.pumping = true;
+
+    while (true) {
+        int lane = 0;
+        for (; lane < LaneCount; ++lane) {
+            QList<Job> &jobs = queue.lanes[lane];
+            while (!jobs.isEmpty() && jobs.first().owner.isNull()) {
+                jobs.removeFirst();
+            }
+            if (!jobs.isEmpty()) {
+                break;
+            }
+        }
+        if (lane == LaneCount) {
+            break;
+        }
+
+        // 只看优先级最高的非空通道：低优先级请求不能抢在等待中的高优先级请求之前
+        const qint64 now = TranslationMetrics::nowUs();
+        const qint64 wait = queue.lastSendUs < 0
+            ? 0 : queue.lastSendUs + intervalUs(engine, static_cast<Lane>(lane)) - now;
+        if (wait > 0) {
+            if (!queue.timer) {
+                queue.timer = new QTimer(this);
+                queue.timer->setSingleShot(true);
+                connect(queue.timer, &QTimer::timeout, this, [this, engine]() { pump(engine); });
+            }
+            queue.timer->start(static_cast<int>((wait + 999) / 1000));
+            break;
+        }
+
+        Job job = queue.lanes[lane].takeFirst();
+        queue.lastSendUs = now;
+        job.send();
+    }
+
+    queue.pumping = false;
+}
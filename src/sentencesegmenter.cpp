@@ -0,0 +1,130 @@
+#include "sentencesegmenter.h"
+
+#include <QSet>
+
+namespace {
+
+bool isClosingMark(QChar c) {
+    return c == '"' || c == '\'' || c == ')' || c == ']' || c == QChar(0x201D) || c == QChar(0x2019)
+           || c == QChar(0x300D) || c == QChar(0x300F) || c == QChar(0xFF09);
+}
+
+bool isCjkTerminator(QChar c) {
+    return c == QChar(0x3002) || c == QChar(0xFF01) || c == QChar(0xFF1F);   // 。！？
+}
+
+bool isCjk(QChar c) {
+    return c.unicode() >= 0x3000;
+}
+
+} // namespace
+
+bool SentenceSegmenter::isSentenceEnd(const QString &text, int pos) {
+    QChar c = text.at(pos);
+    if (isCjkTerminator(c)) {
+        return true;
+    }
+    if (c != '.' && c != '!' && c != '?' && c != QChar(0x2026)) {
+        return false;
+    }
+
+    // 西文句末标点后必须跟空白或文本结尾，避免切开 3.5、example.com
+    int next = pos + 1;
+    while (next < text.size() && isClosingMark(text.at(next))) ++next;
+    if (next < text.size() && !text.at(next).isSpace()) {
+        return false;
+    }
+
+    if (c == '.') {
+        // 常见缩写与单字母缩写（首字母）不算句末
+        static const QSet<QString> abbreviations = {
+            "e.g", "i.e", "etc", "vs", "Mr", "Mrs", "Ms", "Dr", "St", "No", "approx"
+        };
+        int start = pos;
+        while (start > 0 && (text.at(start - 1).isLetter() || text.at(start - 1) == '.')) --start;
+        QString word = text.mid(start, pos - start);
+        if (abbreviations.contains(word) || (word.size() == 1 && word.at(0).isUpper())) {
+            return false;
+        }
+    }
+    return true;
+}
+
+SentenceSegmenter::Segmented SentenceSegmenter::split(const QString &text) {
+    Segmented result;
+
+    int pos = 0;
+    while (pos < text.size() && text.at(pos).isSpace()) ++pos;
+    result.leading = text.left(pos);
+
+    int segmentStart = pos;
+    while (pos < text.size()) {
+        bool boundary = false;
+        int segmentEnd = pos;
+
+        if (text.at(pos) == '\n') {
+            boundary = true;
+            segmentEnd = pos;
+        } else if (isSentenceEnd(text, pos)) {
+            boundary = true;
+            segmentEnd = pos + 1;
+            while (segmentEnd < text.size() && isClosingMark(text.at(segmentEnd))) ++segmentEnd;
+        }
+
+        if (!boundary) {
+            ++pos;
+            continue;
+        }
+
+        // 句段末尾的空白归入分隔符
+        int trimmedEnd = segmentEnd;
+        while (trimmedEnd > segmentStart && text.at(trimmedEnd - 1).isSpace()) --trimmedEnd;
+
+        int separatorEnd = segmentEnd;
+        while (separatorEnd < text.size() && text.at(separatorEnd).isSpace()) ++separatorEnd;
+
+        if (trimmedEnd > segmentStart) {
+            result.segments.append(text.mid(segmentStart, trimmedEnd - segmentStart));
+            result.separators.append(text.mid(trimmedEnd, separatorEnd - trimmedEnd));
+        } else if (!result.separators.isEmpty()) {
+            // 连续换行：并入上一个分隔符
+            result.separators.last() += text.mid(segmentStart, separatorEnd - segmentStart);
+        } else {
+            result.leading += text.mid(segmentStart, separatorEnd - segmentStart);
+        }
+        pos = segmentStart = separatorEnd;
+    }
+
+    if (segmentStart < text.size()) {
+        int trimmedEnd = text.size();
+        while (trimmedEnd > segmentStart && text.at(trimmedEnd - 1).isSpace()) --trimmedEnd;
+        result.segments.append(text.mid(segmentStart, trimmedEnd - segmentStart));
+        result.separators.append(text.mid(trimmedEnd));
+    }
+    return result;
+}
+
+QString SentenceSegmenter::join(const Segmented &segmented, const QStringList &translations) {
+    QString result = segmented.leading;
+    for (int i = 0; i < translations.size() && i < segmented.separators.size(); ++i) {
+        const QString &translated = translations.at(i);
+        result += translated;
+
+        const QString &separator = segmented.separators.at(i);
+        bool spacesOnly = !separator.isEmpty() && separator.trimmed().isEmpty() && !separator.contains('\n');
+        bool lastSegment = i == translations.size() - 1;
+        if (spacesOnly && !lastSegment && !translated.isEmpty() && isCjk(translated.at(translated.size() - 1))) {
+            continue;
+        }
+        result += separator;
+    }
+    return result;
+}
+
+bool SentenceSegmenter::needsTranslation(const QString &segment) {
+    // 哨兵 {n} 中只有数字与花括号，不含字母
+    for (QChar c : segment) {
+        if (c.isLetter()) return true;
+    }
+    return false;
+}
@@ -0,0 +1,257 @@
+#include "streamtranslator.h"
+
+#include "translationservice.h"
+#include "tracerecorder.h"
+
+namespace {
+
+// 窗口内缓冲的非待译项（已完成消息、上下文边界）上限，相对于窗口大小
+const int BufferFactor = 8;
+
+// 与界面批量翻译的选择一致：未完成或译文为空，废弃条目除外
+bool needsTranslation(const TsEntry &entry) {
+    if (entry.state == TranslationState::Obsolete || entry.state == TranslationState::Vanished) {
+        return false;
+    }
+    return !entry.source.isEmpty()
+           && (entry.state == TranslationState::Unfinished || entry.translation.isEmpty());
+}
+
+} // namespace
+
+StreamTranslator::StreamTranslator(TranslationService *service, QObject *parent)
+    : QObject(parent), m_service(service) {
+    connect(m_service, &TranslationService::singleTranslationCompleted,
+            [this](const QString &, const QString &source, const QString &translation) {
+                applyResult(source, translation, TranslationState::Finished);
+            });
+    // 占位符丢失的译文写入但保持未完成，与界面中的处理一致
+    connect(m_service, &TranslationService::placeholderMismatch,
+            [this](const QString &source, const QString &translation, const QStringList &) {
+                applyResult(source, translation, TranslationState::Unfinished);
+            });
+    connect(m_service, &TranslationService::batchTranslationCompleted, this, &StreamTranslator::onBatchCompleted);
+    connect(m_service, &TranslationService::errorOccurred, this, &StreamTranslator::onError);
+}
+
+void StreamTranslator::setWindowSize(int messages) {
+    m_windowSize = qMax(1, messages);
+}
+
+bool StreamTranslator::start(const QString &inputPath, const QString &outputPath) {
+    if (m_running) {
+        return false;
+    }
+    m_input.setFileName(inputPath);
+    if (!m_input.open(QIODevice::ReadOnly)) {
+        emit finished(false, "无法打开文件: " + inputPath);
+        return false;
+    }
+    m_output.setFileName(outputPath);
+    if (!m_output.open(QIODevice::WriteOnly)) {
+        m_input.close();
+        emit finished(false, "无法写入文件: " + outputPath);
+        return false;
+    }
+
+    m_reader.setDevice(&m_input);
+    m_writer.setDevice(&m_output);
+    m_writer.setAutoFormatting(true);
+    m_writer.setAutoFormattingIndent(2);
+    m_writer.writeStartDocument();
+
+    m_currentContext.clear();
+    m_window.clear();
+    m_windowBase = 0;
+    m_waiting.clear();
+    m_lastError.clear();
+    m_messages = m_translated = m_failed = 0;
+    m_running = true;
+    nextWindow();
+    return true;
+}
+
+void StreamTranslator::cancel() {
+    if (!m_running) {
+        return;
+    }
+    if (m_batchRunning) {
+        m_batchRunning = false;
+        m_service->cancelBatch();
+    }
+    finish(false, "已取消");
+}
+
+void StreamTranslator::nextWindow() {
+    if (!m_running) {
+        return;
+    }
+    fillWindow();
+
+    if (m_reader.hasError()) {
+        finish(false, QString("解析失败（第 %1 行）: %2").arg(m_reader.lineNumber()).arg(m_reader.errorString()));
+        return;
+    }
+    if (m_waiting.isEmpty()) {
+        // 队首没有待译消息时窗口已全部写出，只有读到文件末尾才会出现这种情况
+        finish(true);
+        return;
+    }
+
+    QStringList texts;
+    QStringList contexts;
+    texts.reserve(m_waiting.size());
+    contexts.reserve(m_waiting.size());
+    for (auto it = m_waiting.constBegin(); it != m_waiting.constEnd(); ++it) {
+        texts.append(it.key());
+        contexts.append(m_window.at(int(it.value().first() - m_windowBase)).entry.context);
+    }
+
+    m_batchRunning = true;
+    m_lastError.clear();
+    m_service->translateBatch(texts, contexts);
+    // 全部命中缓存时批次在调用中就已完成；既未完成也未开始说明引擎不可用
+    if (m_batchRunning && !m_service->isBatchRunning()) {
+        m_batchRunning = false;
+        finish(false, m_lastError.isEmpty() ? "无法开始翻译" : m_lastError);
+    }
+}
+
+void StreamTranslator::fillWindow() {
+    TraceScope trace("StreamTranslator::fillWindow", "io");
+    // 待译消息达到窗口大小，或队首消息后积压的项过多时停止读取，形成背压
+    while (!m_reader.atEnd() && m_waiting.size() < m_windowSize
+           && m_window.size() < m_windowSize * BufferFactor) {
+        QXmlStreamReader::TokenType token = m_reader.readNext();
+        if (token == QXmlStreamReader::StartElement) {
+            if (m_reader.name() == QLatin1String("TS")) {
+                m_writer.writeStartElement("TS");
+                m_writer.writeAttributes(m_reader.attributes());
+            } else if (m_reader.name() == QLatin1String("context")) {
+                readContextName();
+            } else if (m_reader.name() == QLatin1String("message")) {
+                Item item{Item::Message, TsEntry(), false};
+                item.entry.context = m_currentContext;
+                TsFileHandler::readMessage(m_reader, item.entry);
+                item.pending = needsTranslation(item.entry);
+                ++m_messages;
+                push(std::move(item));
+            }
+        } else if (token == QXmlStreamReader::EndElement && m_reader.name() == QLatin1String("context")) {
+            push(Item{Item::ContextEnd, TsEntry(), false});
+        }
+    }
+}
+
+void StreamTranslator::readContextName() {
+    m_currentContext.clear();
+    if (m_reader.readNextStartElement() && m_reader.name() == QLatin1String("name")) {
+        m_currentContext = m_reader.readElementText();
+    }
+    Item item{Item::ContextStart, TsEntry(), false};
+    item.entry.context = m_currentContext;
+    push(std::move(item));
+    // 名称之前就出现消息的异常文件：直接读取该消息
+    if (m_reader.tokenType() == QXmlStreamReader::StartElement && m_reader.name() == QLatin1String("message")) {
+        Item message{Item::Message, TsEntry(), false};
+        message.entry.context = m_currentContext;
+        TsFileHandler::readMessage(m_reader, message.entry);
+        message.pending = needsTranslation(message.entry);
+        ++m_messages;
+        push(std::move(message));
+    } else if (m_reader.tokenType() == QXmlStreamReader::EndElement && m_reader.name() == QLatin1String("context")) {
+        push(Item{Item::ContextEnd, TsEntry(), false});
+    }
+}
+
+void StreamTranslator::push(Item &&item) {
+    const qint64 sequence = m_windowBase + m_window.size();
+    if (item.pending) {
+        m_waiting[item.entry.source].append(sequence);
+    }
+    m_window.append(std::move(item));
+    flush();
+}
+
+void StreamTranslator::flush() {
+    while (!m_window.isEmpty() && !m_window.first().pending) {
+        writeItem(m_window.first());
+        m_window.removeFirst();
+        ++m_windowBase;
+    }
+}
+
+void StreamTranslator::writeItem(const Item &item) {
+    switch (item.kind) {
+    case Item::ContextStart:
+        m_writer.writeStartElement("context");
+        m_writer.writeTextElement("name", item.entry.context);
+        break;
+    case Item::ContextEnd:
+        m_writer.writeEndElement(); // context
+        break;
+    case Item::Message:
+        TsFileHandler::writeMessage(m_writer, item.entry);
+        break;
+    }
+}
+
+void StreamTranslator::applyResult(const QString &source, const QString &translation, TranslationState state) {
+    if (!m_batchRunning) {
+        return;
+    }
+    const QList<qint64> sequences = m_waiting.take(source);
+    for (qint64 sequence : sequences) {
+        Item &item = m_window[int(sequence - m_windowBase)];
+        item.entry.translation = translation;
+        item.entry.state = state;
+        item.pending = false;
+        ++m_translated;
+    }
+    flush();
+}
+
+void StreamTranslator::onBatchCompleted() {
+    if (!m_batchRunning) {
+        return;
+    }
+    m_batchRunning = false;
+
+    // 没有返回译文的消息原样写出
+    for (auto it = m_waiting.constBegin(); it != m_waiting.constEnd(); ++it) {
+        for (qint64 sequence : it.value()) {
+            m_window[int(sequence - m_windowBase)].pending = false;
+            ++m_failed;
+        }
+    }
+    m_waiting.clear();
+    flush();
+    emit progress(m_translated, m_failed, m_messages);
+
+    // 批次可能在 translateBatch 调用内同步完成，下一个窗口回到事件循环后再开始
+    QMetaObject::invokeMethod(this, &StreamTranslator::nextWindow, Qt::QueuedConnection);
+}
+
+void StreamTranslator::onError(const QString &errorMessage) {
+    if (m_running) {
+        m_lastError = errorMessage;
+    }
+}
+
+void StreamTranslator::finish(bool success, const QString &errorMessage) {
+    m_running = false;
+    m_input.close();
+    if (success) {
+        m_writer.writeEndElement(); // TS
+        m_writer.writeEndDocument();
+        if (!m_output.commit()) {
+            success = false;
+        }
+    } else {
+        m_output.cancelWriting();
+        m_output.commit();
+    }
+    m_window.clear();
+    m_waiting.clear();
+    emit finished(success, success ? QString() : (errorMessage.isEmpty() ? "无法写入输出文件" : errorMessage));
+}
@@ -0,0 +1,116 @@
+#include "tracerecorder.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutexLocker>
+#include <QThread>
+
+TraceRecorder &TraceRecorder::instance() {
+    static TraceRecorder recorder;
+    return recorder;
+}
+
+qint64 TraceRecorder::nowUs() {
+    static QElapsedTimer clock = [] {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed() / 1000;
+}
+
+void TraceRecorder::start() {
+    QMutexLocker locker(&m_mutex);
+    m_events.clear();
+    m_events.reserve(4096);
+    m_enabled.store(true, std::memory_order_relaxed);
+}
+
+void TraceRecorder::startFromEnvironment() {
+    QString path = qEnvironmentVariable("QTTS_TRACE_FILE");
+    if (path.isEmpty()) {
+        return;
+    }
+    m_environmentPath = path;
+    start();
+}
+
+bool TraceRecorder::stop(const QString &filePath) {
+    m_enabled.store(false, std::memory_order_relaxed);
+
+    QVector<Event> events;
+    {
+        QMutexLocker locker(&m_mutex);
+        events.swap(m_events);
+    }
+
+    if (filePath.isEmpty()) {
+        return true;
+    }
+
+    const qint64 pid = QCoreApplication::applicationPid();
+    QJsonArray traceEvents;
+    for (const Event &event : events) {
+        QJsonObject obj;
+        obj["name"] = QString::fromLatin1(event.name);
+        obj["cat"] = QString::fromLatin1(event.category);
+        obj["ph"] = QString(QChar::fromLatin1(event.phase));
+        obj["ts"] = event.timestampUs;
+        obj["pid"] = pid;
+        obj["tid"] = static_cast<qint64>(event.threadId);
+        if (event.phase == 'X') {
+            obj["dur"] = event.durationUs;
+        } else {
+            obj["id"] = QString("0x%1").arg(event.id, 0, 16);
+        }
+        if (!event.detail.isEmpty()) {
+            obj["args"] = QJsonObject{{"detail", event.detail}};
+        }
+        traceEvents.append(obj);
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    file.close();
+    return true;
+}
+
+void TraceRecorder::append(Event &&event) {
+    QMutexLocker locker(&m_mutex);
+    if (!isEnabled()) {
+        return;
+    }
+    m_events.append(std::move(event));
+}
+
+void TraceRecorder::completeEvent(const char *name, const char *category,
+                                  qint64 startUs, qint64 durationUs, const QString &detail) {
+    if (!isEnabled()) return;
+    append({name, category, 'X', startUs, durationUs, 0,
+            reinterpret_cast<quintptr>(QThread::currentThreadId()), detail});
+}
+
+void TraceRecorder::asyncBegin(const char *name, const char *category, quint64 id,
+                               const QString &detail) {
+    if (!isEnabled()) return;
+    append({name, category, 'b', nowUs(), 0, id,
+            reinterpret_cast<quintptr>(QThread::currentThreadId()), detail});
+}
+
+void TraceRecorder::asyncEnd(const char *name, const char *category, quint64 id,
+                             const QString &detail) {
+    if (!isEnabled()) return;
+    append({name, category, 'e', nowUs(), 0, id,
+            reinterpret_cast<quintptr>(QThread::currentThreadId()), detail});
+}
@@ -0,0 +1,35 @@
+#include "translationcache.h"
+
+TranslationCache::TranslationCache(int maxEntries) {
+    m_entries.setMaxCost(maxEntries);
+}
+
+QString TranslationCache::key(int engine, const QString &sourceLang, const QString &targetLang,
+                              const QString &text) {
+    return QString("%1|%2|%3|%4").arg(engine).arg(sourceLang, targetLang, text);
+}
+
+bool TranslationCache::lookup(const QString &key, QString &translation) {
+    QString *cached = m_entries.object(key);
+    if (!cached) {
+        m_misses++;
+        return false;
+    }
+    m_hits++;
+    translation = *cached;
+    return true;
+}
+
+void TranslationCache::insert(const QString &key, const QString &translation) {
+    m_entries.insert(key, new QString(translation));
+}
+
+void TranslationCache::remove(const QString &key) {
+    m_entries.remove(key);
+}
+
+void TranslationCache::clear() {
+    m_entries.clear();
+    m_hits = 0;
+    m_misses = 0;
+}
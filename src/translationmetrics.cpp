@@ -0,0 +1,225 @@
+#include "translationmetrics.h"
+
+#include <QElapsedTimer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QFile>
+#include <QMutexLocker>
+#include <QtAlgorithms>
+#include <QtMath>
+
+// ---------------- LatencyHistogram ----------------
+
+int LatencyHistogram::bucketIndex(qint64 value) {
+    if (value < 16) {
+        return value < 0 ? 0 : static_cast<int>(value);
+    }
+    int msb = 63 - static_cast<int>(qCountLeadingZeroBits(static_cast<quint64>(value)));
+    int shift = msb - 4;
+    return 16 * shift + static_cast<int>(value >> shift);
+}
+
+qint64 LatencyHistogram::bucketUpperBound(int index) {
+    if (index < 16) {
+        return index;
+    }
+    int shift = index / 16 - 1;
+    qint64 base = index - 16 * shift;
+    return ((base + 1) << shift) - 1;
+}
+
+void LatencyHistogram::record(qint64 valueUs) {
+    if (valueUs < 0) valueUs = 0;
+
+    int index = bucketIndex(valueUs);
+    if (index >= m_buckets.size()) {
+        m_buckets.resize(index + 1);
+    }
+    m_buckets[index]++;
+
+    if (m_count == 0 || valueUs < m_min) m_min = valueUs;
+    if (valueUs > m_max) m_max = valueUs;
+    m_count++;
+    m_sum += valueUs;
+}
+
+void LatencyHistogram::reset() {
+    m_buckets.clear();
+    m_count = 0;
+    m_sum = 0;
+    m_min = 0;
+    m_max = 0;
+}
+
+double LatencyHistogram::mean() const {
+    return m_count > 0 ? static_cast<double>(m_sum) / m_count : 0;
+}
+
+qint64 LatencyHistogram::percentile(double percent) const {
+    if (m_count == 0) return 0;
+
+    qint64 target = qCeil(m_count * qBound(0.0, percent, 100.0) / 100.0);
+    if (target < 1) target = 1;
+
+    qint64 seen = 0;
+    for (int i = 0; i < m_buckets.size(); ++i) {
+        seen += m_buckets.at(i);
+        if (seen >= target) {
+            return qMin(bucketUpperBound(i), m_max);
+        }
+    }
+    return m_max;
+}
+
+QJsonObject LatencyHistogram::toJson() const {
+    QJsonObject obj;
+    obj["count"] = m_count;
+    obj["min_us"] = min();
+    obj["mean_us"] = mean();
+    obj["p50_us"] = percentile(50);
+    obj["p90_us"] = percentile(90);
+    obj["p95_us"] = percentile(95);
+    obj["p99_us"] = percentile(99);
+    obj["max_us"] = m_max;
+
+    // 只导出非空桶：[上界, 计数]
+    QJsonArray buckets;
+    for (int i = 0; i < m_buckets.size(); ++i) {
+        if (m_buckets.at(i) > 0) {
+            buckets.append(QJsonArray{bucketUpperBound(i), m_buckets.at(i)});
+        }
+    }
+    obj["buckets"] = buckets;
+    return obj;
+}
+
+// ---------------- TranslationMetrics ----------------
+
+TranslationMetrics::TranslationMetrics(QObject *parent) : QObject(parent) {}
+
+TranslationMetrics *TranslationMetrics::instance() {
+    static TranslationMetrics metrics;
+    return &metrics;
+}
+
+qint64 TranslationMetrics::nowUs() {
+    static QElapsedTimer clock = [] {
+        QElapsedTimer timer;
+        timer.start();
+        return timer;
+    }();
+    return clock.nsecsElapsed() / 1000;
+}
+
+void TranslationMetrics::requestStarted(TranslationService::Engine engine) {
+    QMutexLocker locker(&m_mutex);
+    m_stats[engine].summary.inFlight++;
+}
+
+void TranslationMetrics::requestFinished(TranslationService::Engine engine, qint64 queueUs,
+                                         qint64 networkUs, qint64 parseUs, int characters,
+                                         bool success) {
+    QMutexLocker locker(&m_mutex);
+    EngineStats &stats = m_stats[engine];
+    EngineSummary &summary = stats.summary;
+
+    summary.inFlight = qMax(0, summary.inFlight - 1);
+    summary.requests++;
+    if (!success) {
+        summary.errors++;
+    }
+    summary.characters += characters;
+    summary.queueWait.record(queueUs);
+    summary.network.record(networkUs);
+    summary.parse.record(parseUs);
+
+    qint64 now = nowUs();
+    stats.recent.enqueue({now, characters});
+    trimRateWindow(stats, now);
+}
+
+void TranslationMetrics::recordApply(TranslationService::Engine engine, qint64 applyUs) {
+    QMutexLocker locker(&m_mutex);
+    m_stats[engine].summary.apply.record(applyUs);
+}
+
+void TranslationMetrics::trimRateWindow(EngineStats &stats, qint64 now) const {
+    const qint64 windowStart = now - RateWindowSeconds * 1000000LL;
+    while (!stats.recent.isEmpty() && stats.recent.head().atUs < windowStart) {
+        stats.recent.dequeue();
+    }
+}
+
+void TranslationMetrics::updateRates(EngineStats &stats, qint64 now) const {
+    trimRateWindow(stats, now);
+
+    qint64 characters = 0;
+    for (const RateSample &sample : stats.recent) {
+        characters += sample.characters;
+    }
+    stats.summary.requestsPerSecond = static_cast<double>(stats.recent.size()) / RateWindowSeconds;
+    stats.summary.charactersPerSecond = static_cast<double>(characters) / RateWindowSeconds;
+}
+
+QList<TranslationService::Engine> TranslationMetrics::engines() const {
+    QMutexLocker locker(&m_mutex);
+    return m_stats.keys();
+}
+
+TranslationMetrics::EngineSummary TranslationMetrics::summary(TranslationService::Engine engine) const {
+    QMutexLocker locker(&m_mutex);
+    auto it = m_stats.find(engine);
+    if (it == m_stats.end()) {
+        return EngineSummary();
+    }
+    updateRates(it.value(), nowUs());
+    return it.value().summary;
+}
+
+QJsonObject TranslationMetrics::toJson() const {
+    QMutexLocker locker(&m_mutex);
+    qint64 now = nowUs();
+
+    QJsonObject enginesObj;
+    for (auto it = m_stats.begin(); it != m_stats.end(); ++it) {
+        updateRates(it.value(), now);
+        const EngineSummary &summary = it.value().summary;
+
+        QJsonObject obj;
+        obj["requests"] = summary.requests;
+        obj["errors"] = summary.errors;
+        obj["characters"] = summary.characters;
+        obj["in_flight"] = summary.inFlight;
+        obj["requests_per_second"] = summary.requestsPerSecond;
+        obj["characters_per_second"] = summary.charactersPerSecond;
+        obj["queue_wait"] = summary.queueWait.toJson();
+        obj["network"] = summary.network.toJson();
+        obj["parse"] = summary.parse.toJson();
+        obj["apply"] = summary.apply.toJson();
+        enginesObj[TranslationService::engineName(it.key())] = obj;
+    }
+
+    QJsonObject root;
+    root["unit"] = "us";
+    root["engines"] = enginesObj;
+    return root;
+}
+
+bool TranslationMetrics::exportJson(const QString &filePath) const {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        return false;
+    }
+    file.write(QJsonDocument(toJson()).toJson(QJsonDocument::Indented));
+    file.close();
+    return true;
+}
+
+void TranslationMetrics::reset() {
+    QMutexLocker locker(&m_mutex);
+    for (auto it = m_stats.begin(); it != m_stats.end(); ++it) {
+        int inFlight = it.value().summary.inFlight;
+        it.value() = EngineStats();
+        it.value().summary.inFlight = inFlight;
+    }
+}
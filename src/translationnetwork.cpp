@@ -0,0 +1,355 @@
+#include "translationnetwork.h"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSslConfiguration>
+#include "translationmetrics.h"
+#include "tracerecorder.h"
+
+TranslationNetwork::TranslationNetwork(QObject *parent)
+    : QObject(parent), m_networkManager(new QNetworkAccessManager(this)) {}
+
+TranslationNetwork *TranslationNetwork::instance() {
+    static TranslationNetwork *network = [] {
+        QThread *thread = new QThread;
+        thread->setObjectName("TranslationNetwork");
+
+        // 管理器是网络对象的子对象，随之一起移动到网络线程
+        TranslationNetwork *object = new TranslationNetwork;
+        object->moveToThread(thread);
+        QObject::connect(thread, &QThread::finished, object, &QObject::deleteLater);
+        thread->start();
+
+        QObject::connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit, [thread] {
+            thread->quit();
+            thread->wait();
+            delete thread;
+        });
+        return object;
+    }();
+    return network;
+}
+
+void TranslationNetwork::submit(const std::shared_ptr<ReplyChannel> &channel,
+                                const TranslationRequest &request) {
+    QMetaObject::invokeMethod(this, [this, channel, request] {
+        startRequest(channel, request);
+    }, Qt::QueuedConnection);
+}
+
+void TranslationNetwork::warmUp(const QUrl &url) {
+    QMetaObject::invokeMethod(this, [this, url] {
+        // 预先完成 DNS、TCP 与 TLS 握手，首个翻译请求无需再等待
+#ifndef QT_NO_SSL
+        QSslConfiguration sslConfig = QSslConfiguration::defaultConfiguration();
+        sslConfig.setAllowedNextProtocols({QSslConfiguration::ALPNProtocolHTTP2,
+                                           QSslConfiguration::NextProtocolHttp1_1});
+        m_networkManager->connectToHostEncrypted(url.host(), url.port(443), sslConfig);
+#else
+        m_networkManager->connectToHost(url.host(), url.port(80));
+#endif
+    }, Qt::QueuedConnection);
+}
+
+void TranslationNetwork::abort(quint64 requestId) {
+    QMetaObject::invokeMethod(this, [this, requestId] {
+        for (auto it = m_pending.begin(); it != m_pending.end(); ++it) {
+            QList<Waiter> &waiters = it.value().waiters;
+            for (int i = 0; i < waiters.size(); ++i) {
+                if (waiters.at(i).request.id != requestId) {
+                    continue;
+                }
+                // 还有其他调用方在等同一个响应时只摘下这一个，不取消网络请求
+                if (waiters.size() > 1) {
+                    Waiter waiter = waiters.takeAt(i);
+                    TranslationReply result = replyFor(waiter, TranslationMetrics::nowUs());
+                    result.aborted = true;
+                    result.errorMessage = "请求已取消";
+                    deliver(waiter.channel, std::move(result));
+                } else {
+                    it.value().aborted = true;
+                    it.key()->abort();
+                }
+                return;
+            }
+        }
+    }, Qt::QueuedConnection);
+}
+
+void TranslationNetwork::startRequest(const std::shared_ptr<ReplyChannel> &channel,
+                                      const TranslationRequest &request) {
+    Waiter waiter;
+    waiter.channel = channel;
+    waiter.request = request;
+    waiter.sentAtUs = TranslationMetrics::nowUs();
+
+    // 全部句段都在同一个进行中的请求里时直接挂到该响应上，不再发送：
+    // 单条请求可以由包含该句段的批量请求回答
+    if (!request.flightKeys.isEmpty()) {
+        QNetworkReply *target = m_inFlight.value(request.flightKeys.first());
+        for (int i = 1; target && i < request.flightKeys.size(); ++i) {
+            if (m_inFlight.value(request.flightKeys.at(i)) != target) {
+                target = nullptr;
+            }
+        }
+        if (target) {
+            waiter.coalesced = true;
+            m_pending[target].waiters.append(waiter);
+            return;
+        }
+    }
+
+    QNetworkReply *reply = request.post
+        ? m_networkManager->post(request.request, request.body)
+        : m_networkManager->get(request.request);
+
+    PendingRequest pending;
+    pending.request = request;
+    pending.waiters.append(waiter);
+    m_pending.insert(reply, pending);
+    // 已在其他请求中的句段仍归原请求，之后的调用方挂到先完成的那个上
+    for (const QString &key : request.flightKeys) {
+        if (!m_inFlight.contains(key)) {
+            m_inFlight.insert(key, reply);
+        }
+    }
+
+    connect(reply, &QNetworkReply::finished, this, [this, reply] {
+        onReplyFinished(reply);
+    });
+}
+
+TranslationReply TranslationNetwork::replyFor(const Waiter &waiter, qint64 finishedAt) {
+    const TranslationRequest &request = waiter.request;
+    if (request.traceId != 0) {
+        TraceRecorder::instance().asyncEnd("translate", "network", request.traceId,
+                                           TranslationService::engineName(request.engine));
+    }
+
+    TranslationReply result;
+    result.id = request.id;
+    result.engine = request.engine;
+    result.isBatch = request.isBatch;
+    result.originalText = request.originalText;
+    result.characters = request.characters;
+    result.coalesced = waiter.coalesced;
+    result.queueUs = waiter.sentAtUs - request.queuedAtUs;
+    result.networkUs = finishedAt - waiter.sentAtUs;
+    return result;
+}
+
+void TranslationNetwork::onReplyFinished(QNetworkReply *reply) {
+    reply->deleteLater();
+    auto it = m_pending.find(reply);
+    if (it == m_pending.end()) {
+        return;
+    }
+    PendingRequest pending = it.value();
+    m_pending.erase(it);
+
+    const TranslationRequest &sent = pending.request;
+    for (const QString &key : sent.flightKeys) {
+        auto inFlight = m_inFlight.find(key);
+        if (inFlight != m_inFlight.end() && inFlight.value() == reply) {
+            m_inFlight.erase(inFlight);
+        }
+    }
+
+    // 记录各阶段耗时：排队 -> 网络 -> 解析；响应只解析一次，结果分发给所有等待者
+    qint64 finishedAt = TranslationMetrics::nowUs();
+    TraceScope trace("TranslationNetwork::parse", "network");
+
+    TranslationReply parsed;
+    parsed.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    if (pending.aborted) {
+        parsed.aborted = true;
+        parsed.errorMessage = "请求已取消";
+    } else if (reply->error() != QNetworkReply::NoError) {
+        parsed.networkError = true;
+        parsed.errorMessage = QString("网络错误: %1").arg(reply->errorString());
+    } else {
+        parseResponse(reply->readAll(), sent, parsed);
+    }
+    qint64 parseUs = TranslationMetrics::nowUs() - finishedAt;
+
+    // 按句段取出译文，等待者的请求形式（单条/批量）可以与实际发送的不同
+    QMap<QString, QString> segments = parsed.batchResults;
+    if (!sent.isBatch && !parsed.translatedText.isEmpty()) {
+        segments.insert(sent.originalText, parsed.translatedText);
+    }
+
+    for (const Waiter &waiter : std::as_const(pending.waiters)) {
+        const TranslationRequest &request = waiter.request;
+        TranslationReply result = replyFor(waiter, finishedAt);
+        result.errorMessage = parsed.errorMessage;
+        if (request.isBatch) {
+            for (const QString &text : request.batchTexts) {
+                auto segment = segments.constFind(text);
+                if (segment != segments.constEnd()) {
+                    result.batchResults.insert(text, segment.value());
+                }
+            }
+            if (result.errorMessage.isEmpty() && result.batchResults.isEmpty()) {
+                result.errorMessage = "批量翻译结果为空";
+            }
+        } else {
+            result.translatedText = segments.value(request.originalText);
+            if (result.errorMessage.isEmpty() && result.translatedText.isEmpty()) {
+                result.errorMessage = "翻译结果为空";
+            }
+        }
+        result.errorCode = parsed.errorCode;
+        result.networkError = parsed.networkError;
+        result.aborted = parsed.aborted;
+        result.httpStatus = parsed.httpStatus;
+        result.parseUs = parseUs;
+        deliver(waiter.channel, std::move(result));
+    }
+}
+
+void TranslationNetwork::deliver(const std::shared_ptr<ReplyChannel> &channel, TranslationReply &&reply) {
+    channel->queue.push(std::move(reply));
+    // 只在通道由空变为非空时通知GUI线程，GUI线程一次取走全部结果
+    if (!channel->notifyPending.exchange(true, std::memory_order_acq_rel)) {
+        emit repliesReady();
+    }
+}
+
+void TranslationNetwork::parseResponse(const QByteArray &response, const TranslationRequest &request,
+                                       TranslationReply &reply) {
+    switch (request.engine) {
+        case TranslationService::GoogleTranslate:
+            if (request.isBatch) {
+                QJsonDocument doc = QJsonDocument::fromJson(response);
+                QJsonObject obj = doc.object().value("data").toObject();
+                QJsonArray translations = obj.value("translations").toArray();
+
+                // 响应按请求顺序返回
+                for (int i = 0; i < translations.size() && i < request.batchTexts.size(); ++i) {
+                    QString translated = translations.at(i).toObject().value("translatedText").toString();
+                    reply.batchResults[request.batchTexts.at(i)] = translated;
+                }
+            } else {
+                reply.translatedText = parseGoogleResponse(response);
+            }
+            break;
+
+        case TranslationService::BaiduTranslate:
+            reply.translatedText = parseBaiduResponse(response, reply);
+            if (request.isBatch && reply.errorMessage.isEmpty()) {
+                // 多行请求：trans_result 按行返回
+                QJsonArray transResults = QJsonDocument::fromJson(response).object().value("trans_result").toArray();
+                for (int i = 0; i < transResults.size() && i < request.batchTexts.size(); ++i) {
+                    QString translated = transResults.at(i).toObject().value("dst").toString();
+                    reply.batchResults[request.batchTexts.at(i)] = translated;
+                }
+            }
+            break;
+
+        case TranslationService::DeepLTranslate:
+            if (request.isBatch) {
+                QJsonDocument doc = QJsonDocument::fromJson(response);
+                QJsonArray translations = doc.object().value("translations").toArray();
+
+                for (int i = 0; i < translations.size() && i < request.batchTexts.size(); ++i) {
+                    QString translated = translations.at(i).toObject().value("text").toString();
+                    reply.batchResults[request.batchTexts.at(i)] = translated;
+                }
+            } else {
+                reply.translatedText = parseDeepLResponse(response);
+            }
+            break;
+
+        case TranslationService::YoudaoTranslate:
+            reply.translatedText = parseYoudaoResponse(response, reply);
+            break;
+    }
+
+    if (!reply.errorMessage.isEmpty()) {
+        return;
+    }
+    if (request.isBatch && reply.batchResults.isEmpty()) {
+        reply.errorMessage = "批量翻译结果为空";
+    } else if (!request.isBatch && reply.translatedText.isEmpty()) {
+        reply.errorMessage = "翻译结果为空";
+    }
+}
+
+QString TranslationNetwork::parseGoogleResponse(const QByteArray &response) {
+    QJsonDocument doc = QJsonDocument::fromJson(response);
+    QJsonObject obj = doc.object().value("data").toObject();
+    QJsonArray translations = obj.value("translations").toArray();
+
+    if (!translations.isEmpty()) {
+        return translations.first().toObject().value("translatedText").toString();
+    }
+    return "";
+}
+
+QString TranslationNetwork::parseBaiduResponse(const QByteArray &response, TranslationReply &reply) {
+    QJsonDocument doc = QJsonDocument::fromJson(response);
+
+    // 检查错误
+    if (doc.object().contains("error_code")) {
+        // 百度的 error_code 可能是字符串
+        int errorCode = doc.object().value("error_code").toVariant().toInt();
+        QString errorMsg = doc.object().value("error_msg").toString();
+
+        // 常见错误代码处理
+        switch (errorCode) {
+            case 52001: errorMsg = "请求超时"; break;
+            case 52002: errorMsg = "系统错误"; break;
+            case 52003: errorMsg = "未授权用户"; break;
+            case 54000: errorMsg = "必填参数为空"; break;
+            case 54001: errorMsg = "签名错误"; break;
+            case 54003: errorMsg = "访问频率受限"; break;
+            case 54004: errorMsg = "账户余额不足"; break;
+            case 54005: errorMsg = "长请求频繁"; break;
+            case 58000: errorMsg = "客户端IP非法"; break;
+            case 58001: errorMsg = "译文语言不支持"; break;
+            case 58002: errorMsg = "服务已关闭"; break;
+        }
+
+        reply.errorCode = errorCode;
+        reply.errorMessage = QString("百度翻译错误 (%1): %2").arg(errorCode).arg(errorMsg);
+        return "";
+    }
+
+    QJsonArray transResults = doc.object().value("trans_result").toArray();
+
+    if (!transResults.isEmpty()) {
+        return transResults.first().toObject().value("dst").toString();
+    }
+    return "";
+}
+
+QString TranslationNetwork::parseDeepLResponse(const QByteArray &response) {
+    QJsonDocument doc = QJsonDocument::fromJson(response);
+    QJsonArray translations = doc.object().value("translations").toArray();
+
+    if (!translations.isEmpty()) {
+        return translations.first().toObject().value("text").toString();
+    }
+    return "";
+}
+
+QString TranslationNetwork::parseYoudaoResponse(const QByteArray &response, TranslationReply &reply) {
+    QJsonDocument doc = QJsonDocument::fromJson(response);
+
+    // 有道以 errorCode 字符串返回状态，"0" 表示成功
+    QString errorCode = doc.object().value("errorCode").toString();
+    if (!errorCode.isEmpty() && errorCode != "0") {
+        reply.errorCode = errorCode.toInt();
+        reply.errorMessage = QString("有道翻译错误 (%1)").arg(errorCode);
+        return "";
+    }
+
+    QJsonArray translations = doc.object().value("translation").toArray();
+
+    if (!translations.isEmpty()) {
+        return translations.first().toString();
+    }
+    return "";
+}
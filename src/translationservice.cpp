@@ -8,18 +8,19 @@
 #include <QUrl>
 #include <QRandomGenerator>
 #include <QTimer>
+#include <QRegularExpression>
+#include <QSignalBlocker>
+#include "translationnetwork.h"
+#include "requestscheduler.h"
+#include "sentencesegmenter.h"
+#include "translationmetrics.h"
+#include "tracerecorder.h"
 
-struct {
-    QStringList batchQueue;
-    QMap<QString, QString> batchResults;
-    int currentBatchIndex = 0;
-    int batchTotal = 0;
-} batchState;
 bool TranslationService::isBatchRunning() const {
-    return !batchState.batchQueue.isEmpty();
+    return !m_batchState.batchQueue.isEmpty();
 }
 TranslationService::TranslationService(QObject *parent)
-    : QObject(parent), m_networkManager(new QNetworkAccessManager(this)),
+    : QObject(parent), m_replyChannel(std::make_shared<ReplyChannel>()),
       m_currentEngine(GoogleTranslate) {
     QSettings settings;
     Engine engines[] = {GoogleTranslate, BaiduTranslate, DeepLTranslate, YoudaoTranslate};
@@ -37,14 +38,60 @@ TranslationService::TranslationService(QObject *parent)
     int savedEngine = settings.value("Translation/currentEngine", GoogleTranslate).toInt();
     m_currentEngine = static_cast<Engine>(savedEngine);
 
-    connect(m_networkManager, &QNetworkAccessManager::finished,
-            this, &TranslationService::onTranslationFinished);
+    m_shardingEnabled = settings.value("Translation/sharding", false).toBool();
+    m_pinnedEngine = settings.value("Translation/pinnedEngine", -1).toInt();
+    m_pinnedContexts = settings.value("Translation/pinnedContexts").toStringList();
+    m_prefetchBudget = settings.value("Translation/prefetchBudget", 20000).toLongLong();
+    m_phrasebookFiles = settings.value("Translation/phrasebooks").toStringList();
+    m_phrasebook = Phrasebook::open(m_phrasebookFiles);
+
+    // 定期检查是否有请求慢于该引擎的 p95，发送对冲请求
+    m_hedgeTimer = new QTimer(this);
+    m_hedgeTimer->setInterval(250);
+    connect(m_hedgeTimer, &QTimer::timeout, this, &TranslationService::hedgeSlowRequests);
+
+    // 所有服务实例共用一个网络线程，使并发请求复用同一条 HTTP/2 连接
+    connect(TranslationNetwork::instance(), &TranslationNetwork::repliesReady,
+            this, &TranslationService::drainReplies);
+}
+
+TranslationService::~TranslationService() = default;
+
+QUrl TranslationService::engineEndpoint(Engine engine) {
+    switch (engine) {
+        case GoogleTranslate: return QUrl("https://translation.googleapis.com/language/translate/v2");
+        case BaiduTranslate: return QUrl("https://fanyi-api.baidu.com/api/trans/vip/translate");
+        case DeepLTranslate: return QUrl("https://api-free.deepl.com/v2/translate");
+        case YoudaoTranslate: return QUrl("https://openapi.youdao.com/api");
+    }
+    return QUrl();
+}
+
+QNetworkRequest TranslationService::createRequest(const QUrl &url) {
+    QNetworkRequest request(url);
+    // 允许 HTTP/2（端点不支持时由 ALPN 回退到 HTTP/1.1），并允许流水线
+    request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+    request.setAttribute(QNetworkRequest::HttpPipeliningAllowedAttribute, true);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    // 单个请求的硬上限，慢请求通常在此之前已被对冲
+    request.setTransferTimeout(30000);
+#endif
+    return request;
+}
+
+void TranslationService::warmUpConnection() {
+    if (m_engineConfigs[m_currentEngine].apiKey.isEmpty()) {
+        return;
+    }
+
+    TranslationNetwork::instance()->warmUp(engineEndpoint(m_currentEngine));
 }
 
 void TranslationService::setCurrentEngine(Engine engine) {
     m_currentEngine = engine;
     QSettings settings;
     settings.setValue("Translation/currentEngine", static_cast<int>(engine));
+    warmUpConnection();
 }
 
 void TranslationService::setApiKey(Engine engine, const QString &apiKey) {
@@ -65,19 +112,96 @@ void TranslationService::setLanguages(Engine engine, const QString &sourceLang,
     settings.setValue(engineKey + "targetLang", targetLang);
 }
 
+void TranslationService::setShardingEnabled(bool enabled) {
+    m_shardingEnabled = enabled;
+    QSettings settings;
+    settings.setValue("Translation/sharding", enabled);
+}
+
+void TranslationService::setPinnedEngine(int engine, const QStringList &contextPatterns) {
+    m_pinnedEngine = engine;
+    m_pinnedContexts = contextPatterns;
+    QSettings settings;
+    settings.setValue("Translation/pinnedEngine", engine);
+    settings.setValue("Translation/pinnedContexts", contextPatterns);
+}
+
+bool TranslationService::setPhrasebooks(const QStringList &fileNames, QString *errorMessage) {
+    QString error;
+    m_phrasebookFiles = fileNames;
+    m_phrasebook = Phrasebook::open(fileNames, &error);
+    QSettings settings;
+    settings.setValue("Translation/phrasebooks", fileNames);
+    if (errorMessage) {
+        *errorMessage = error;
+    }
+    return error.isEmpty();
+}
+
+void TranslationService::setPriorityContexts(const QStringList &contexts) {
+    QSet<QString> priority;
+    for (const QString &context : contexts) {
+        priority.insert(context);
+    }
+    if (priority == m_priorityContexts) {
+        return;
+    }
+    m_priorityContexts = priority;
+    if (isBatchRunning()) {
+        rebuildPriorityQueue();
+    }
+}
+
+void TranslationService::setRemainingQuota(Engine engine, qint64 characters) {
+    RequestScheduler::instance()->setRemainingQuota(engine, characters);
+}
+
+qint64 TranslationService::remainingQuota(Engine engine) const {
+    return RequestScheduler::instance()->remainingQuota(engine);
+}
+
 void TranslationService::translateText(const QString &text) {
     if (text.isEmpty()) {
         emit errorOccurred("源文本为空");
         return;
     }
 
+    translateMasked(PlaceholderMasker::mask(text));
+}
+
+void TranslationService::translateMasked(const PlaceholderMasker::MaskedText &masked) {
+    // 只有占位符和标记的文本无需发送，原样作为译文；短语库与缓存命中时同样直接返回。
+    // 短语库不需要网络，未设置密钥时也可以使用
+    QString cached;
+    if (!masked.needsTranslation) {
+        deliverResult(masked, masked.masked);
+        return;
+    }
+    if (lookupPhrasebook(masked.masked, cached)) {
+        deliverResult(masked, cached);
+        return;
+    }
+
     QString apiKey = m_engineConfigs[m_currentEngine].apiKey;
     if (apiKey.isEmpty()) {
         emit errorOccurred(QString("%1 API密钥未设置").arg(engineName(m_currentEngine)));
         return;
     }
+    if (m_cache.lookup(cacheKey(m_currentEngine, masked.masked), cached)) {
+        deliverResult(masked, cached);
+        return;
+    }
 
-    switch (m_currentEngine) {
+    // 交互请求走最高优先级通道，排在同一引擎的批量与预取请求之前
+    const Engine engine = m_currentEngine;
+    RequestScheduler::instance()->submit(engine, RequestScheduler::Interactive, this, [this, engine, masked]() {
+        m_pendingMasks = {masked};
+        translateWithEngine(engine, masked.masked);
+    });
+}
+
+void TranslationService::translateWithEngine(Engine engine, const QString &text) {
+    switch (engine) {
         case GoogleTranslate:
             translateWithGoogle(text);
             break;
@@ -93,58 +217,694 @@ void TranslationService::translateText(const QString &text) {
     }
 }
 
-void TranslationService::translateBatch(const QStringList &texts) {
+void TranslationService::setPrefetchBudget(qint64 characters) {
+    m_prefetchBudget = characters;
+    QSettings settings;
+    settings.setValue("Translation/prefetchBudget", characters);
+}
+
+void TranslationService::prefetch(const QStringList &texts) {
+    // 选中的条目变化后，之前排队的邻近条目已不再需要
+    m_prefetchQueue.clear();
+    m_scheduledPrefetch.clear();
+    RequestScheduler::instance()->cancel(this, RequestScheduler::Prefetch);
+    if (isBatchRunning() || m_engineConfigs[m_currentEngine].apiKey.isEmpty()) {
+        return;
+    }
+
+    for (const QString &text : texts) {
+        PlaceholderMasker::MaskedText masked = PlaceholderMasker::mask(text);
+        QString key = cacheKey(m_currentEngine, masked.masked);
+        QString phrase;
+        if (masked.needsTranslation && !m_prefetchKeys.contains(key) && !m_cache.contains(key)
+            && !lookupPhrasebook(masked.masked, phrase)) {
+            m_prefetchQueue.append(masked);
+        }
+    }
+    sendNextPrefetch();
+}
+
+void TranslationService::sendNextPrefetch() {
+    // 最多同时进行（含在调度器中排队）两个预取请求，批量翻译开始后不再发送
+    while (m_prefetchRequests.size() + m_scheduledPrefetch.size() < 2 && !m_prefetchQueue.isEmpty()
+           && !isBatchRunning()) {
+        PlaceholderMasker::MaskedText masked = m_prefetchQueue.takeFirst();
+        QString key = cacheKey(m_currentEngine, masked.masked);
+        if (m_prefetchKeys.contains(key) || m_scheduledPrefetch.contains(key) || m_cache.contains(key)) {
+            continue;
+        }
+
+        int characters = masked.masked.size();
+        qint64 quota = remainingQuota(m_currentEngine);
+        if (m_prefetchSpent + characters > m_prefetchBudget || (quota >= 0 && quota < characters)) {
+            m_prefetchQueue.clear();
+            return;
+        }
+
+        // 预取走最低优先级通道，只使用交互与批量请求剩下的发送间隔
+        m_scheduledPrefetch.insert(key);
+        const Engine engine = m_currentEngine;
+        RequestScheduler::instance()->submit(engine, RequestScheduler::Prefetch, this,
+                                             [this, engine, masked, key]() {
+            sendPrefetch(engine, masked, key);
+        });
+    }
+}
+
+void TranslationService::sendPrefetch(Engine engine, const PlaceholderMasker::MaskedText &masked,
+                                      const QString &key) {
+    // 排队期间被新的预取替换或批量翻译已开始时不再发送
+    if (!m_scheduledPrefetch.remove(key) || isBatchRunning()) {
+        return;
+    }
+    if (m_cache.contains(key)) {
+        sendNextPrefetch();
+        return;
+    }
+
+    int sent = m_prefetchRequests.size();
+    m_pendingMasks = {masked};
+    m_pendingPrefetch = true;
+    {
+        // 预取失败不打扰用户，例如密钥格式错误
+        QSignalBlocker blocker(this);
+        translateWithEngine(engine, masked.masked);
+    }
+    m_pendingPrefetch = false;
+    if (m_prefetchRequests.size() == sent) {
+        m_pendingMasks.clear();
+        m_prefetchQueue.clear();
+        return;
+    }
+    m_prefetchSpent += masked.masked.size();
+    m_prefetchKeys.insert(key);
+}
+
+void TranslationService::translateBatch(const QStringList &texts, const QStringList &contexts) {
     if (texts.isEmpty()) {
         emit errorOccurred("没有要翻译的文本");
         return;
     }
+    m_prefetchQueue.clear();
+    m_scheduledPrefetch.clear();
+    RequestScheduler::instance()->cancel(this, RequestScheduler::Prefetch);
+
+    // 没有可用引擎时仍先用短语库翻译，只有未命中的句段才需要密钥
+    const QList<Engine> engines = batchEngines();
+    const bool pinning = m_pinnedEngine >= 0 && engines.contains(static_cast<Engine>(m_pinnedEngine))
+                         && !m_pinnedContexts.isEmpty();
+
+    // 重置批量翻译状态，丢弃上一批次尚未返回的结果
+    m_batchState = BatchState();
+    m_batchGeneration++;
+    m_batchState.batchQueue = texts;
+    m_batchState.contexts = contexts;
+    m_batchState.maskedQueue = PlaceholderMasker::maskAll(texts);
+    m_batchState.batchTotal = texts.size();
+    m_batchState.segmented.resize(texts.size());
+    m_batchState.pendingSegments.resize(texts.size());
+    m_batchState.failed.resize(texts.size());
+    for (Engine engine : engines) {
+        m_batchState.lanes.insert(engine, EngineLane());
+    }
 
-    QString apiKey = m_engineConfigs[m_currentEngine].apiKey;
-    if (apiKey.isEmpty()) {
-        emit errorOccurred(QString("%1 API密钥未设置").arg(engineName(m_currentEngine)));
-        return;
+    // 固定上下文的文本先入队，共享的句段优先交给固定引擎
+    QVector<int> order;
+    order.reserve(texts.size());
+    QVector<bool> pinned(texts.size(), false);
+    for (int i = 0; i < texts.size(); ++i) {
+        pinned[i] = pinning && isPinnedContext(contexts.value(i));
+        if (pinned.at(i)) order.append(i);
+    }
+    for (int i = 0; i < texts.size(); ++i) {
+        if (!pinned.at(i)) order.append(i);
+    }
+
+    // 切分句段：不需要翻译或缓存命中的句段直接得到结果，其余在整批范围内去重后排队
+    const QList<Engine> pinnedEngines = {static_cast<Engine>(m_pinnedEngine)};
+    for (int i : std::as_const(order)) {
+        const QString &masked = m_batchState.maskedQueue.at(i).masked;
+        QString phrase;
+        if (m_batchState.maskedQueue.at(i).needsTranslation && lookupPhrasebook(masked, phrase)) {
+            // 短语库中的整条文本（可能包含多个句子）不再切分
+            SentenceSegmenter::Segmented whole;
+            whole.segments = QStringList{masked};
+            whole.separators = QStringList{QString()};
+            m_batchState.segmentResults.insert(masked, phrase);
+            m_batchState.segmented[i] = whole;
+            continue;
+        }
+
+        SentenceSegmenter::Segmented segmented = SentenceSegmenter::split(masked);
+        int pending = 0;
+        for (const QString &segment : std::as_const(segmented.segments)) {
+            if (m_batchState.segmentResults.contains(segment)) {
+                continue;
+            }
+            QString cached;
+            if (!SentenceSegmenter::needsTranslation(segment)) {
+                m_batchState.segmentResults.insert(segment, segment);
+                continue;
+            }
+            if (lookupPhrasebook(segment, cached)) {
+                m_batchState.segmentResults.insert(segment, cached);
+                continue;
+            }
+            if (lookupCached(pinned.at(i) ? pinnedEngines : engines, segment, cached)) {
+                m_batchState.segmentResults.insert(segment, cached);
+                continue;
+            }
+
+            QList<int> &waiters = m_batchState.waiting[segment];
+            if (waiters.isEmpty()) {
+                (pinned.at(i) ? m_batchState.pinnedQueue : m_batchState.segmentQueue).append(segment);
+            }
+            waiters.append(i);
+            pending++;
+        }
+        m_batchState.segmented[i] = segmented;
+        m_batchState.pendingSegments[i] = pending;
     }
+    rebuildPriorityQueue();
 
-    // 重置批量翻译状态
-    batchState.batchQueue = texts;
-    batchState.batchResults.clear();
-    batchState.currentBatchIndex = 0;
-    batchState.batchTotal = texts.size();
     emit batchProgress(0, texts.size());
+    for (int i = 0; i < texts.size(); ++i) {
+        if (m_batchState.pendingSegments.at(i) == 0) {
+            completeBatchText(i);
+        }
+    }
+    if (engines.isEmpty() && !m_batchState.waiting.isEmpty()) {
+        const QStringList missing = m_batchState.waiting.keys();
+        emit errorOccurred(QString("%1 API密钥未设置，%2 个句段不在短语库中，未翻译")
+                               .arg(engineName(m_currentEngine)).arg(missing.size()));
+        for (const QString &segment : missing) {
+            resolveSegment(segment, false);
+        }
+    }
+    m_hedgeTimer->start();
     translateNextInBatch();
 }
 
+QList<TranslationService::Engine> TranslationService::batchEngines() const {
+    QList<Engine> engines;
+    for (Engine engine : supportedEngines()) {
+        const EngineConfig config = m_engineConfigs.value(engine);
+        bool wanted = m_shardingEnabled || engine == m_currentEngine
+                      || (engine == m_pinnedEngine && !m_pinnedContexts.isEmpty());
+        if (wanted && !config.apiKey.isEmpty() && remainingQuota(engine) != 0) {
+            engines.append(engine);
+        }
+    }
+    return engines;
+}
+
+bool TranslationService::isPinnedContext(const QString &context) const {
+    for (const QString &pattern : m_pinnedContexts) {
+        QRegularExpression regex(QRegularExpression::wildcardToRegularExpression(pattern.trimmed()));
+        if (regex.match(context).hasMatch()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool TranslationService::lookupPhrasebook(const QString &masked, QString &translation) const {
+    // 短语库命中的文本不经过网络，也不消耗额度
+    return m_phrasebook && m_phrasebook->lookup(masked, translation);
+}
+
+bool TranslationService::lookupCached(const QList<Engine> &engines, const QString &segment, QString &translation) {
+    for (Engine engine : engines) {
+        if (m_cache.lookup(cacheKey(engine, segment), translation)) {
+            m_batchState.segmentEngines.insert(segment, engine);
+            return true;
+        }
+    }
+    return false;
+}
+
+void TranslationService::packLimits(Engine engine, int &maxSegments, int &maxCharacters) {
+    // 把多个句段打包进一个请求，受各引擎的条数与长度上限约束；发送间隔由 RequestScheduler 控制
+    maxSegments = 1;
+    maxCharacters = 0;
+    switch (engine) {
+        case GoogleTranslate:
+            maxSegments = 100;
+            maxCharacters = 1800;   // GET 请求受 URL 长度限制
+            break;
+        case DeepLTranslate:
+            maxSegments = 50;
+            maxCharacters = 4000;
+            break;
+        case BaiduTranslate:
+            maxSegments = 50;
+            maxCharacters = 1800;   // 百度单次请求上限约 6000 字节
+            break;
+        case YoudaoTranslate:
+            break;
+    }
+}
+
+void TranslationService::rebuildPriorityQueue() {
+    // 从尚未发送的普通句段中挑出属于优先上下文的句段，保持原有顺序
+    m_batchState.priorityQueue.clear();
+    m_batchState.nextPriority = 0;
+    if (m_priorityContexts.isEmpty() || m_batchState.contexts.isEmpty()) {
+        return;
+    }
+    const QStringList &queue = m_batchState.segmentQueue;
+    for (int i = m_batchState.nextSegment; i < queue.size(); ++i) {
+        auto waiters = m_batchState.waiting.constFind(queue.at(i));
+        if (waiters == m_batchState.waiting.cend()) {
+            continue;
+        }
+        for (int index : waiters.value()) {
+            if (m_priorityContexts.contains(m_batchState.contexts.value(index))) {
+                m_batchState.priorityQueue.append(queue.at(i));
+                break;
+            }
+        }
+    }
+}
+
+QStringList TranslationService::takePack(Engine engine, bool &pinned, bool &priority) {
+    int maxSegments, maxCharacters;
+    packLimits(engine, maxSegments, maxCharacters);
+
+    // 额度不足时缩小包，剩余额度放不下一个句段则不再拉取；
+    // 批量翻译不使用最后 10%（至多 2000 字符）的额度，留给用户点击的单条翻译
+    qint64 quota = remainingQuota(engine);
+    if (quota >= 0) {
+        quota -= qMin<qint64>(2000, quota / 10);
+        maxCharacters = static_cast<int>(qMin<qint64>(qMax(maxCharacters, 1), quota));
+    }
+
+    QStringList pack;
+    auto fill = [&](const QStringList &queue, int &next) {
+        int characters = 0;
+        while (next < queue.size() && pack.size() < maxSegments) {
+            const QString &segment = queue.at(next);
+            // 已被其他引擎完成，或已作为优先上下文的句段发出
+            if (!m_batchState.waiting.contains(segment) || m_batchState.inFlightCopies.contains(segment)) {
+                next++;
+                continue;
+            }
+            bool fits = characters + segment.size() <= maxCharacters;
+            if (!fits && (!pack.isEmpty() || (quota >= 0 && segment.size() > quota))) {
+                break;
+            }
+            pack.append(segment);
+            characters += segment.size();
+            next++;
+        }
+    };
+
+    // 固定引擎先取固定上下文的句段，其次是当前选中上下文的句段，最后是其余句段
+    pinned = engine == m_pinnedEngine && m_batchState.nextPinned < m_batchState.pinnedQueue.size();
+    priority = false;
+    if (pinned) {
+        fill(m_batchState.pinnedQueue, m_batchState.nextPinned);
+        return pack;
+    }
+    fill(m_batchState.priorityQueue, m_batchState.nextPriority);
+    priority = !pack.isEmpty();
+    if (!priority) {
+        fill(m_batchState.segmentQueue, m_batchState.nextSegment);
+    }
+    return pack;
+}
+
 void TranslationService::translateNextInBatch() {
-    if (batchState.currentBatchIndex >= batchState.batchQueue.size()) {
-        emit batchTranslationCompleted(batchState.batchResults);
+    if (m_batchState.batchQueue.isEmpty()) {
+        return;
+    }
+    if (m_batchState.completedTexts >= m_batchState.batchTotal) {
+        QMap<QString, QString> results = m_batchState.batchResults;
+        m_batchState = BatchState();
+        m_hedgeTimer->stop();
+        emit batchTranslationCompleted(results);
         return;
     }
 
-    QString text = batchState.batchQueue[batchState.currentBatchIndex];
-    batchState.currentBatchIndex++;
+    // 拉取模式：每个空闲引擎各取一包，吞吐高的引擎自然分到更多工作
+    bool anyBusy = false;
+    const QList<Engine> engines = m_batchState.lanes.keys();
+    for (Engine engine : engines) {
+        if (!m_batchState.lanes.value(engine).busy) {
+            bool pinned = false;
+            bool priority = false;
+            QStringList pack = takePack(engine, pinned, priority);
+            if (!pack.isEmpty()) {
+                scheduleLane(engine, pack, pinned, priority);
+            }
+        }
+        anyBusy = anyBusy || m_batchState.lanes.value(engine).busy;
+    }
+
+    // 所有引擎都无法继续（额度用完或不可用），剩余句段按失败处理
+    if (!anyBusy && m_batchState.inFlightCopies.isEmpty()) {
+        QStringList remaining = m_batchState.waiting.keys();
+        if (!remaining.isEmpty()) {
+            emit errorOccurred("没有可继续工作的翻译引擎（额度用完或不可用），剩余条目未翻译");
+            for (const QString &segment : std::as_const(remaining)) {
+                resolveSegment(segment, false);
+            }
+        }
+    }
+}
+
+void TranslationService::scheduleLane(Engine engine, const QStringList &pack, bool pinned, bool priority) {
+    EngineLane &lane = m_batchState.lanes[engine];
+    lane.busy = true;
+    lane.pinnedPack = pinned;
+    lane.hedged = false;
+    lane.pack = pack;
+    lane.sentAtUs = 0;
+    for (const QString &segment : pack) {
+        m_batchState.inFlightCopies[segment]++;
+    }
+
+    // 由调度器按引擎的频率限制放行，交互请求优先
+    qint64 queuedAt = TranslationMetrics::nowUs();
+    quint64 generation = m_batchGeneration;
+    RequestScheduler::Lane schedulerLane = priority ? RequestScheduler::Visible : RequestScheduler::Background;
+    RequestScheduler::instance()->submit(engine, schedulerLane, this, [this, engine, pack, queuedAt, generation]() {
+        if (generation != m_batchGeneration) {
+            return;
+        }
+        m_batchState.lanes[engine].sentAtUs = TranslationMetrics::nowUs();
+        m_nextQueuedAtUs = queuedAt;
+        sendSegmentPack(engine, pack);
+        m_nextQueuedAtUs = -1;
+    });
+}
 
-    int delay = 0;
-    switch (m_currentEngine) {
+void TranslationService::sendSegmentPack(Engine engine, const QStringList &pack, bool hedge) {
+    m_pendingSegments = pack;
+    m_pendingHedge = hedge;
+    switch (engine) {
+        case GoogleTranslate:
+            batchTranslateWithGoogle(pack);
+            break;
         case BaiduTranslate:
+            batchTranslateWithBaidu(pack);
+            break;
+        case DeepLTranslate:
+            batchTranslateWithDeepL(pack);
+            break;
         case YoudaoTranslate:
-            delay = 1000; // 1000ms 延迟避免频率限制
+            batchTranslateWithYoudao(pack);
             break;
+    }
+    m_pendingHedge = false;
+
+    // 请求未能发出（如密钥格式错误）时按失败处理，避免批次停滞
+    if (!m_pendingSegments.isEmpty()) {
+        m_pendingSegments.clear();
+        auto lane = m_batchState.lanes.find(engine);
+        if (!hedge && lane != m_batchState.lanes.end()) {
+            lane.value() = EngineLane();
+        }
+        for (const QString &segment : pack) {
+            releaseSegment(segment, false);
+        }
+        translateNextInBatch();
+    }
+}
+
+void TranslationService::onSegmentsFinished(const TranslationReply &reply, const SegmentRequest &request) {
+    if (request.generation != m_batchGeneration) {
+        return;
+    }
+    auto lane = m_batchState.lanes.find(reply.engine);
+    if (!request.hedge && lane != m_batchState.lanes.end()) {
+        lane.value() = EngineLane();
+    }
+
+    // 账户级错误：本批次不再使用该引擎，句段交给其他引擎
+    const bool fatal = isFatalEngineError(reply);
+    if (fatal) {
+        markEngineUnhealthy(reply.engine, reply.errorMessage);
+    } else if (!reply.errorMessage.isEmpty() && !reply.aborted) {
+        QList<int> waiters = m_batchState.waiting.value(request.segments.first());
+        emit errorOccurred(reply.errorMessage,
+                           waiters.isEmpty() ? QString() : m_batchState.batchQueue.at(waiters.first()));
+    }
+
+    for (int i = 0; i < request.segments.size(); ++i) {
+        const QString &segment = request.segments.at(i);
+        QString translated;
+        if (reply.errorMessage.isEmpty()) {
+            translated = reply.isBatch ? reply.batchResults.value(segment)
+                                       : (i == 0 ? reply.translatedText : QString());
+        }
+
+        if (!translated.isEmpty()) {
+            m_cache.insert(cacheKey(reply.engine, segment), translated);
+            // 对冲的句段以先返回的结果为准
+            if (m_batchState.waiting.contains(segment)) {
+                m_batchState.segmentResults.insert(segment, translated);
+                m_batchState.segmentEngines.insert(segment, reply.engine);
+            }
+        }
+
+        if (fatal) {
+            requeueSegment(segment);
+        } else {
+            releaseSegment(segment, !translated.isEmpty());
+        }
+    }
+
+    abortSettledRequests();
+    translateNextInBatch();
+}
+
+void TranslationService::releaseSegment(const QString &segment, bool success) {
+    int copies = --m_batchState.inFlightCopies[segment];
+    if (copies <= 0) {
+        m_batchState.inFlightCopies.remove(segment);
+    }
+    // 失败时若另一个引擎仍在翻译同一句段，则等待它的结果
+    if (success || copies <= 0) {
+        resolveSegment(segment, success);
+    }
+}
+
+void TranslationService::requeueSegment(const QString &segment) {
+    int copies = --m_batchState.inFlightCopies[segment];
+    if (copies <= 0) {
+        m_batchState.inFlightCopies.remove(segment);
+        if (m_batchState.waiting.contains(segment)) {
+            m_batchState.segmentQueue.append(segment);
+        }
+    }
+}
+
+void TranslationService::resolveSegment(const QString &segment, bool success) {
+    const QList<int> waiters = m_batchState.waiting.take(segment);
+    for (int index : waiters) {
+        if (!success) {
+            m_batchState.failed[index] = true;
+        }
+        if (--m_batchState.pendingSegments[index] == 0) {
+            completeBatchText(index);
+        }
+    }
+}
+
+void TranslationService::completeBatchText(int index) {
+    m_batchState.completedTexts++;
+
+    if (!m_batchState.failed.at(index)) {
+        const SentenceSegmenter::Segmented &segmented = m_batchState.segmented.at(index);
+        QStringList translations;
+        translations.reserve(segmented.segments.size());
+        for (const QString &segment : segmented.segments) {
+            translations.append(m_batchState.segmentResults.value(segment));
+        }
+
+        const PlaceholderMasker::MaskedText &masked = m_batchState.maskedQueue.at(index);
+        if (!deliverResult(masked, SentenceSegmenter::join(segmented, translations), index)) {
+            // 占位符丢失的句段不再从缓存命中
+            for (const QString &segment : segmented.segments) {
+                auto engine = m_batchState.segmentEngines.constFind(segment);
+                if (engine != m_batchState.segmentEngines.constEnd()) {
+                    m_cache.remove(cacheKey(engine.value(), segment));
+                }
+            }
+        }
+    }
+
+    emit batchProgress(m_batchState.completedTexts, m_batchState.batchTotal);
+}
+
+bool TranslationService::isFatalEngineError(const TranslationReply &reply) {
+    if (reply.aborted) {
+        return false;
+    }
+    // 鉴权失败或额度耗尽（DeepL 以 HTTP 456 表示额度用完）
+    if (reply.httpStatus == 401 || reply.httpStatus == 403 || reply.httpStatus == 456) {
+        return true;
+    }
+    switch (reply.engine) {
+        case BaiduTranslate:
+            // 未授权、余额不足、IP 非法、服务已关闭、认证失败
+            return reply.errorCode == 52003 || reply.errorCode == 54004 || reply.errorCode == 58000
+                   || reply.errorCode == 58002 || reply.errorCode == 90107;
+        case YoudaoTranslate:
+            // 应用ID无效、账户欠费
+            return reply.errorCode == 108 || reply.errorCode == 401;
         default:
-            delay = 100;
+            return false;
     }
+}
 
-    // 延迟后翻译
-    QTimer::singleShot(delay, this, [this, text]() {
-        translateText(text);
-        emit batchProgress(batchState.currentBatchIndex, batchState.batchTotal);
-    });
+void TranslationService::markEngineUnhealthy(Engine engine, const QString &reason) {
+    if (m_batchState.unhealthyEngines.contains(engine)) {
+        return;
+    }
+    m_batchState.unhealthyEngines.append(engine);
+    m_batchState.lanes.remove(engine);
+
+    // 固定给该引擎的句段改为共享
+    if (engine == m_pinnedEngine) {
+        for (int i = m_batchState.nextPinned; i < m_batchState.pinnedQueue.size(); ++i) {
+            m_batchState.segmentQueue.append(m_batchState.pinnedQueue.at(i));
+        }
+        m_batchState.nextPinned = m_batchState.pinnedQueue.size();
+    }
+
+    // 没有其他引擎在工作时，启用其余已配置的引擎
+    if (m_batchState.lanes.isEmpty()) {
+        for (Engine candidate : supportedEngines()) {
+            const EngineConfig config = m_engineConfigs.value(candidate);
+            if (!config.apiKey.isEmpty() && remainingQuota(candidate) != 0
+                && !m_batchState.unhealthyEngines.contains(candidate)) {
+                m_batchState.lanes.insert(candidate, EngineLane());
+            }
+        }
+    }
+
+    QStringList names;
+    const QList<Engine> engines = m_batchState.lanes.keys();
+    for (Engine remaining : engines) {
+        names.append(engineName(remaining));
+    }
+    emit errorOccurred(QString("%1 不可用（%2），本批次剩余工作改由 %3 完成")
+                           .arg(engineName(engine), reason, names.isEmpty() ? "无" : names.join("、")));
+}
+
+qint64 TranslationService::hedgeThresholdUs(Engine engine) {
+    // 样本足够时以该引擎的 p95 网络耗时为阈值，否则使用保守的默认值
+    LatencyHistogram network = TranslationMetrics::instance()->summary(engine).network;
+    if (network.count() < 20) {
+        return 10000000;
+    }
+    return qMax<qint64>(network.percentile(95), 500000);
+}
+
+void TranslationService::hedgeSlowRequests() {
+    if (m_batchState.batchQueue.isEmpty()) {
+        m_hedgeTimer->stop();
+        return;
+    }
+
+    const qint64 now = TranslationMetrics::nowUs();
+    const QList<Engine> engines = m_batchState.lanes.keys();
+    for (Engine slow : engines) {
+        const EngineLane lane = m_batchState.lanes.value(slow);
+        if (!lane.busy || lane.hedged || lane.sentAtUs == 0 || now - lane.sentAtUs < hedgeThresholdUs(slow)) {
+            continue;
+        }
+        m_batchState.lanes[slow].hedged = true;
+
+        QStringList pack;
+        for (const QString &segment : lane.pack) {
+            if (m_batchState.waiting.contains(segment)) {
+                pack.append(segment);
+            }
+        }
+        if (pack.isEmpty()) {
+            continue;
+        }
+
+        // 优先交给空闲的其他引擎；固定上下文的包只在同一引擎上对冲
+        bool handedOff = false;
+        if (!lane.pinnedPack) {
+            for (Engine idle : engines) {
+                if (idle != slow && !m_batchState.lanes.value(idle).busy
+                    && remainingQuota(idle) != 0) {
+                    scheduleLane(idle, pack, false, false);
+                    handedOff = true;
+                    break;
+                }
+            }
+        }
+        if (!handedOff) {
+            for (const QString &segment : std::as_const(pack)) {
+                m_batchState.inFlightCopies[segment]++;
+            }
+            // 同一引擎的对冲同样经过调度器，遵守该引擎的频率限制（百度、有道每秒一次）
+            const quint64 generation = m_batchGeneration;
+            RequestScheduler::instance()->submit(slow, RequestScheduler::Background, this,
+                                                 [this, slow, pack, now, generation]() {
+                if (generation != m_batchGeneration) {
+                    return;
+                }
+                // 排队期间原请求已经返回，不再发送
+                bool pending = false;
+                for (const QString &segment : pack) {
+                    pending = pending || m_batchState.waiting.contains(segment);
+                }
+                if (!pending) {
+                    for (const QString &segment : pack) {
+                        if (--m_batchState.inFlightCopies[segment] <= 0) {
+                            m_batchState.inFlightCopies.remove(segment);
+                        }
+                    }
+                    return;
+                }
+                m_nextQueuedAtUs = now;
+                sendSegmentPack(slow, pack, true);
+                m_nextQueuedAtUs = -1;
+            });
+        }
+    }
+}
+
+void TranslationService::abortSettledRequests() {
+    // 句段已全部由其他请求给出结果的请求不再需要，取消以释放连接和额度
+    for (auto it = m_segmentRequests.cbegin(); it != m_segmentRequests.cend(); ++it) {
+        if (it.value().generation != m_batchGeneration || m_abortedRequests.contains(it.key())) {
+            continue;
+        }
+        bool settled = true;
+        for (const QString &segment : it.value().segments) {
+            if (m_batchState.waiting.contains(segment)) {
+                settled = false;
+                break;
+            }
+        }
+        if (settled) {
+            m_abortedRequests.insert(it.key());
+            TranslationNetwork::instance()->abort(it.key());
+        }
+    }
 }
 
 void TranslationService::cancelBatch() {
-    batchState.batchQueue.clear();
-    batchState.batchResults.clear();
-    batchState.currentBatchIndex = 0;
-    batchState.batchTotal = 0;
+    // 取消仍在进行的句段请求，迟到的结果按批次代号丢弃
+    for (auto it = m_segmentRequests.cbegin(); it != m_segmentRequests.cend(); ++it) {
+        if (!m_abortedRequests.contains(it.key())) {
+            m_abortedRequests.insert(it.key());
+            TranslationNetwork::instance()->abort(it.key());
+        }
+    }
+    m_batchState = BatchState();
+    m_batchGeneration++;
+    m_hedgeTimer->stop();
+    RequestScheduler::instance()->cancel(this, RequestScheduler::Visible);
+    RequestScheduler::instance()->cancel(this, RequestScheduler::Background);
     emit batchCanceled();
 }
 
@@ -164,7 +924,7 @@ QString TranslationService::engineName(Engine engine) {
 
 // Google翻译实现
 void TranslationService::translateWithGoogle(const QString &text) {
-    QUrl url("https://translation.googleapis.com/language/translate/v2");
+    QUrl url = engineEndpoint(GoogleTranslate);
     QUrlQuery query;
     query.addQueryItem("key", m_engineConfigs[GoogleTranslate].apiKey);
     query.addQueryItem("q", text);
@@ -173,14 +933,16 @@ void TranslationService::translateWithGoogle(const QString &text) {
     query.addQueryItem("format", "text");
     url.setQuery(query);
 
-    QNetworkRequest request(url);
-    QNetworkReply *reply = m_networkManager->get(request);
-    reply->setProperty("originalText", text);
-    reply->setProperty("engine", GoogleTranslate);
+    TranslationRequest request;
+    request.engine = GoogleTranslate;
+    request.request = createRequest(url);
+    request.originalText = text;
+    request.characters = text.size();
+    dispatch(request);
 }
 
 void TranslationService::batchTranslateWithGoogle(const QStringList &texts) {
-    QUrl url("https://translation.googleapis.com/language/translate/v2");
+    QUrl url = engineEndpoint(GoogleTranslate);
     QUrlQuery query;
     query.addQueryItem("key", m_engineConfigs[GoogleTranslate].apiKey);
     query.addQueryItem("source", toGoogleLanguageCode(m_engineConfigs[GoogleTranslate].sourceLang));
@@ -193,15 +955,18 @@ void TranslationService::batchTranslateWithGoogle(const QStringList &texts) {
 
     url.setQuery(query);
 
-    QNetworkRequest request(url);
-    QNetworkReply *reply = m_networkManager->get(request);
-    reply->setProperty("engine", GoogleTranslate);
-    reply->setProperty("isBatch", true);
+    TranslationRequest request;
+    request.engine = GoogleTranslate;
+    request.request = createRequest(url);
+    request.isBatch = true;
+    request.batchTexts = texts;
+    request.characters = texts.join(QString()).size();
+    dispatch(request);
 }
 
 // 百度翻译实现
 void TranslationService::translateWithBaidu(const QString &text) {
-    QUrl url("https://fanyi-api.baidu.com/api/trans/vip/translate");
+    QUrl url = engineEndpoint(BaiduTranslate);
 
     QString appId = m_engineConfigs[BaiduTranslate].apiKey.split(':').value(0);
     QString secretKey = m_engineConfigs[BaiduTranslate].apiKey.split(':').value(1);
@@ -225,20 +990,58 @@ void TranslationService::translateWithBaidu(const QString &text) {
     query.addQueryItem("salt", salt);
     query.addQueryItem("sign", sign);
 
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
-
-    QNetworkReply *reply = m_networkManager->post(request, query.toString(QUrl::FullyEncoded).toUtf8());
-    reply->setProperty("originalText", text);
-    reply->setProperty("engine", BaiduTranslate);
+    TranslationRequest request;
+    request.engine = BaiduTranslate;
+    request.request = createRequest(url);
+    request.request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    request.post = true;
+    request.body = query.toString(QUrl::FullyEncoded).toUtf8();
+    request.originalText = text;
+    request.characters = text.size();
+    dispatch(request);
 }
 
 void TranslationService::batchTranslateWithBaidu(const QStringList &texts) {
-    translateBatch(texts);
+    QUrl url = engineEndpoint(BaiduTranslate);
+
+    QString appId = m_engineConfigs[BaiduTranslate].apiKey.split(':').value(0);
+    QString secretKey = m_engineConfigs[BaiduTranslate].apiKey.split(':').value(1);
+
+    if (appId.isEmpty() || secretKey.isEmpty()) {
+        emit errorOccurred("百度翻译API密钥格式不正确");
+        return;
+    }
+
+    // 百度按行翻译，trans_result 与各行一一对应
+    QString text = texts.join('\n');
+    QString salt = QString::number(QRandomGenerator::global()->generate());
+    QString sign = QCryptographicHash::hash(
+        (appId + text + salt + secretKey).toUtf8(),
+        QCryptographicHash::Md5
+    ).toHex();
+
+    QUrlQuery query;
+    query.addQueryItem("q", text);
+    query.addQueryItem("from", toBaiduLanguageCode(m_engineConfigs[BaiduTranslate].sourceLang));
+    query.addQueryItem("to", toBaiduLanguageCode(m_engineConfigs[BaiduTranslate].targetLang));
+    query.addQueryItem("appid", appId);
+    query.addQueryItem("salt", salt);
+    query.addQueryItem("sign", sign);
+
+    TranslationRequest request;
+    request.engine = BaiduTranslate;
+    request.request = createRequest(url);
+    request.request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    request.post = true;
+    request.body = query.toString(QUrl::FullyEncoded).toUtf8();
+    request.isBatch = true;
+    request.batchTexts = texts;
+    request.characters = text.size();
+    dispatch(request);
 }
 
 void TranslationService::translateWithDeepL(const QString &text) {
-    QUrl url("https://api-free.deepl.com/v2/translate");
+    QUrl url = engineEndpoint(DeepLTranslate);
 
     QUrlQuery query;
     query.addQueryItem("auth_key", m_engineConfigs[DeepLTranslate].apiKey);
@@ -246,16 +1049,19 @@ void TranslationService::translateWithDeepL(const QString &text) {
     query.addQueryItem("source_lang", toDeepLLanguageCode(m_engineConfigs[DeepLTranslate].sourceLang));
     query.addQueryItem("target_lang", toDeepLLanguageCode(m_engineConfigs[DeepLTranslate].targetLang));
 
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
-
-    QNetworkReply *reply = m_networkManager->post(request, query.toString(QUrl::FullyEncoded).toUtf8());
-    reply->setProperty("originalText", text);
-    reply->setProperty("engine", DeepLTranslate);
+    TranslationRequest request;
+    request.engine = DeepLTranslate;
+    request.request = createRequest(url);
+    request.request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    request.post = true;
+    request.body = query.toString(QUrl::FullyEncoded).toUtf8();
+    request.originalText = text;
+    request.characters = text.size();
+    dispatch(request);
 }
 
 void TranslationService::batchTranslateWithDeepL(const QStringList &texts) {
-    QUrl url("https://api-free.deepl.com/v2/translate");
+    QUrl url = engineEndpoint(DeepLTranslate);
 
     QUrlQuery query;
     query.addQueryItem("auth_key", m_engineConfigs[DeepLTranslate].apiKey);
@@ -266,16 +1072,20 @@ void TranslationService::batchTranslateWithDeepL(const QStringList &texts) {
         query.addQueryItem("text", text);
     }
 
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
-
-    QNetworkReply *reply = m_networkManager->post(request, query.toString(QUrl::FullyEncoded).toUtf8());
-    reply->setProperty("engine", DeepLTranslate);
-    reply->setProperty("isBatch", true);
+    TranslationRequest request;
+    request.engine = DeepLTranslate;
+    request.request = createRequest(url);
+    request.request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    request.post = true;
+    request.body = query.toString(QUrl::FullyEncoded).toUtf8();
+    request.isBatch = true;
+    request.batchTexts = texts;
+    request.characters = texts.join(QString()).size();
+    dispatch(request);
 }
 
 void TranslationService::translateWithYoudao(const QString &text) {
-    QUrl url("https://openapi.youdao.com/api");
+    QUrl url = engineEndpoint(YoudaoTranslate);
 
     QString appKey = m_engineConfigs[YoudaoTranslate].apiKey.split(':').value(0);
     QString secretKey = m_engineConfigs[YoudaoTranslate].apiKey.split(':').value(1);
@@ -300,172 +1110,147 @@ void TranslationService::translateWithYoudao(const QString &text) {
     query.addQueryItem("sign", sign);
     query.addQueryItem("signType", "v3");
 
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
-
-    QNetworkReply *reply = m_networkManager->post(request, query.toString(QUrl::FullyEncoded).toUtf8());
-    reply->setProperty("originalText", text);
-    reply->setProperty("engine", YoudaoTranslate);
+    TranslationRequest request;
+    request.engine = YoudaoTranslate;
+    request.request = createRequest(url);
+    request.request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    request.post = true;
+    request.body = query.toString(QUrl::FullyEncoded).toUtf8();
+    request.originalText = text;
+    request.characters = text.size();
+    dispatch(request);
 }
 
 void TranslationService::batchTranslateWithYoudao(const QStringList &texts) {
-    translateBatch(texts);
+    // 有道没有多文本接口，句段逐个发送（打包上限为1）
+    translateWithYoudao(texts.value(0));
 }
 
-void TranslationService::onTranslationFinished(QNetworkReply *reply) {
-    if (reply->error() != QNetworkReply::NoError) {
-        QString errorMsg = QString("网络错误: %1").arg(reply->errorString());
-        emit errorOccurred(errorMsg);
-        reply->deleteLater();
-        return;
+void TranslationService::dispatch(TranslationRequest &request) {
+    qint64 now = TranslationMetrics::nowUs();
+    request.id = m_nextRequestId++;
+    request.queuedAtUs = m_nextQueuedAtUs >= 0 ? m_nextQueuedAtUs : now;
+    if (!m_pendingSegments.isEmpty()) {
+        m_segmentRequests.insert(request.id, {m_batchGeneration, m_pendingSegments, m_pendingHedge});
+        m_pendingSegments.clear();
+    } else {
+        m_requestMasks.insert(request.id, m_pendingMasks);
+        m_pendingMasks.clear();
     }
-
-    QByteArray responseData = reply->readAll();
-    Engine engine = static_cast<Engine>(reply->property("engine").toInt());
-    bool isBatch = reply->property("isBatch").toBool();
-    QString originalText = reply->property("originalText").toString();
-
-    QString translatedText;
-    QMap<QString, QString> batchResults;
-
-    switch (engine) {
-        case GoogleTranslate:
-            if (isBatch) {
-                QJsonDocument doc = QJsonDocument::fromJson(responseData);
-                QJsonObject obj = doc.object().value("data").toObject();
-                QJsonArray translations = obj.value("translations").toArray();
-
-                for (const QJsonValue &val : translations) {
-                    QJsonObject transObj = val.toObject();
-                    QString original = transObj.value("original").toString();
-                    QString translated = transObj.value("translatedText").toString();
-                    batchResults[original] = translated;
-                }
-            } else {
-                translatedText = parseGoogleResponse(responseData);
-            }
-            break;
-
-        case BaiduTranslate:
-            translatedText = parseBaiduResponse(responseData);
-            if (!batchState.batchQueue.isEmpty() && !translatedText.isEmpty()) {
-                batchState.batchResults[originalText] = translatedText;
-                emit singleTranslationCompleted("", originalText, translatedText);
-            }
-            break;
-
-        case DeepLTranslate:
-            if (isBatch) {
-                QJsonDocument doc = QJsonDocument::fromJson(responseData);
-                QJsonArray translations = doc.object().value("translations").toArray();
-
-                for (const QJsonValue &val : translations) {
-                    QJsonObject transObj = val.toObject();
-                    QString original = transObj.value("text").toString();
-                    QString translated = transObj.value("text").toString();
-                    batchResults[original] = translated;
-                }
-            } else {
-                translatedText = parseDeepLResponse(responseData);
-            }
-            break;
-
-        case YoudaoTranslate:
-            translatedText = parseYoudaoResponse(responseData);
-            // 保存批量翻译结果
-            if (!batchState.batchQueue.isEmpty() && !translatedText.isEmpty()) {
-                batchState.batchResults[originalText] = translatedText;
-                emit singleTranslationCompleted("", originalText, translatedText);
-            }
-            break;
+    if (m_pendingPrefetch) {
+        // 预取让位于用户正在等待的请求；相同文本的点击仍可合并到该请求上
+        m_prefetchRequests.insert(request.id);
+        request.request.setPriority(QNetworkRequest::LowPriority);
+    } else if (!request.isBatch) {
+        request.request.setPriority(QNetworkRequest::HighPriority);
     }
-
-    if (isBatch) {
-        if (!batchResults.isEmpty()) {
-            emit batchTranslationCompleted(batchResults);
-        } else {
-            emit errorOccurred("批量翻译结果为空");
-        }
-    } else {
-        if (!translatedText.isEmpty()) {
-            emit translationCompleted(originalText, translatedText);
-        } else {
-            emit errorOccurred("翻译结果为空", originalText);
+    // 按引擎、语言对与遮蔽句段合并进行中的请求（跨服务实例）；对冲请求必须真正发出
+    if (!m_pendingHedge) {
+        const QStringList texts = request.isBatch ? request.batchTexts : QStringList(request.originalText);
+        for (const QString &text : texts) {
+            request.flightKeys.append(cacheKey(request.engine, text));
         }
     }
+    TranslationMetrics::instance()->requestStarted(request.engine);
+    RequestScheduler::instance()->consumeQuota(request.engine, request.characters);
 
-    // 继续批量翻译
-    if (!batchState.batchQueue.isEmpty()) {
-        translateNextInBatch();
+    TraceRecorder &tracer = TraceRecorder::instance();
+    if (tracer.isEnabled()) {
+        request.traceId = tracer.nextAsyncId();
+        tracer.asyncBegin("translate", "network", request.traceId, engineName(request.engine));
     }
 
-    reply->deleteLater();
+    // 发送、读取与解析都在网络线程中完成
+    TranslationNetwork::instance()->submit(m_replyChannel, request);
 }
 
-QString TranslationService::parseGoogleResponse(const QByteArray &response) {
-    QJsonDocument doc = QJsonDocument::fromJson(response);
-    QJsonObject obj = doc.object().value("data").toObject();
-    QJsonArray translations = obj.value("translations").toArray();
+void TranslationService::drainReplies() {
+    // 先清除通知标记再取结果，保证不会漏掉新到达的结果
+    m_replyChannel->notifyPending.store(false, std::memory_order_release);
 
-    if (!translations.isEmpty()) {
-        return translations.first().toObject().value("translatedText").toString();
+    TranslationReply reply;
+    while (m_replyChannel->queue.pop(reply)) {
+        onTranslationFinished(reply);
     }
-    return "";
 }
 
-QString TranslationService::parseBaiduResponse(const QByteArray &response) {
-    QJsonDocument doc = QJsonDocument::fromJson(response);
+void TranslationService::onTranslationFinished(const TranslationReply &reply) {
+    TraceScope trace("TranslationService::onTranslationFinished", "network");
+    TranslationMetrics::instance()->requestFinished(reply.engine, reply.queueUs, reply.networkUs,
+                                                    reply.parseUs, reply.characters,
+                                                    reply.errorMessage.isEmpty() || reply.aborted);
+    m_abortedRequests.remove(reply.id);
+    if (reply.coalesced) {
+        // 合并的请求没有单独计费，退回派发时扣除的额度
+        RequestScheduler::instance()->consumeQuota(reply.engine, -reply.characters);
+    }
 
-    // 检查错误
-    if (doc.object().contains("error_code")) {
-        int errorCode = doc.object().value("error_code").toInt();
-        QString errorMsg = doc.object().value("error_msg").toString();
+    auto segmentRequest = m_segmentRequests.find(reply.id);
+    if (segmentRequest != m_segmentRequests.end()) {
+        SegmentRequest request = segmentRequest.value();
+        m_segmentRequests.erase(segmentRequest);
+        onSegmentsFinished(reply, request);
+        return;
+    }
 
-        // 常见错误代码处理
-        switch (errorCode) {
-            case 52001: errorMsg = "请求超时"; break;
-            case 52002: errorMsg = "系统错误"; break;
-            case 52003: errorMsg = "未授权用户"; break;
-            case 54000: errorMsg = "必填参数为空"; break;
-            case 54001: errorMsg = "签名错误"; break;
-            case 54003: errorMsg = "访问频率受限"; break;
-            case 54004: errorMsg = "账户余额不足"; break;
-            case 54005: errorMsg = "长请求频繁"; break;
-            case 58000: errorMsg = "客户端IP非法"; break;
-            case 58001: errorMsg = "译文语言不支持"; break;
-            case 58002: errorMsg = "服务已关闭"; break;
+    QVector<PlaceholderMasker::MaskedText> masks = m_requestMasks.take(reply.id);
+    if (m_prefetchRequests.remove(reply.id)) {
+        if (reply.coalesced) {
+            m_prefetchSpent -= reply.characters;
         }
-
-        emit errorOccurred(QString("百度翻译错误 (%1): %2").arg(errorCode).arg(errorMsg));
-        return "";
+        // 预取结果只写入缓存；占位符不完整的译文不缓存，留到用户点击时重新请求
+        if (!masks.isEmpty()) {
+            QString key = cacheKey(reply.engine, masks.first().masked);
+            QString restored;
+            m_prefetchKeys.remove(key);
+            if (reply.errorMessage.isEmpty()
+                && PlaceholderMasker::unmask(masks.first(), reply.translatedText, restored).isEmpty()) {
+                m_cache.insert(key, reply.translatedText);
+            }
+        }
+        sendNextPrefetch();
+        return;
+    }
+    if (masks.isEmpty()) {
+        return;
     }
 
-    QJsonArray transResults = doc.object().value("trans_result").toArray();
-
-    if (!transResults.isEmpty()) {
-        return transResults.first().toObject().value("dst").toString();
+    if (!reply.errorMessage.isEmpty()) {
+        emit errorOccurred(reply.errorMessage, masks.first().source);
+    } else if (deliverResult(masks.first(), reply.translatedText)) {
+        m_cache.insert(cacheKey(reply.engine, masks.first().masked), reply.translatedText);
     }
-    return "";
 }
 
-QString TranslationService::parseDeepLResponse(const QByteArray &response) {
-    QJsonDocument doc = QJsonDocument::fromJson(response);
-    QJsonArray translations = doc.object().value("translations").toArray();
-
-    if (!translations.isEmpty()) {
-        return translations.first().toObject().value("text").toString();
+bool TranslationService::restoreTranslation(const PlaceholderMasker::MaskedText &masked,
+                                            const QString &translated, QString &result) {
+    QStringList missing = PlaceholderMasker::unmask(masked, translated, result);
+    if (!missing.isEmpty()) {
+        emit placeholderMismatch(masked.source, result, missing);
+        return false;
     }
-    return "";
+    return true;
 }
 
-QString TranslationService::parseYoudaoResponse(const QByteArray &response) {
-    QJsonDocument doc = QJsonDocument::fromJson(response);
-    QJsonArray translations = doc.object().value("translation").toArray();
-
-    if (!translations.isEmpty()) {
-        return translations.first().toString();
+bool TranslationService::deliverResult(const PlaceholderMasker::MaskedText &masked, const QString &translated,
+                                       int batchIndex) {
+    QString result;
+    // 批量翻译进行中时记录结果，并通知逐条应用；占位符丢失的结果交由 placeholderMismatch 处理
+    bool restored = restoreTranslation(masked, translated, result);
+    if (restored && !m_batchState.batchQueue.isEmpty()) {
+        m_batchState.batchResults[masked.source] = result;
+        emit singleTranslationCompleted("", masked.source, result);
+    }
+    if (batchIndex >= 0) {
+        emit batchTextTranslated(batchIndex, result, restored);
     }
-    return "";
+    emit translationCompleted(masked.source, result);
+    return restored;
+}
+
+QString TranslationService::cacheKey(Engine engine, const QString &text) const {
+    const EngineConfig config = m_engineConfigs.value(engine);
+    return TranslationCache::key(engine, config.sourceLang, config.targetLang, text);
 }
 
 QString TranslationService::toGoogleLanguageCode(const QString &lang) {
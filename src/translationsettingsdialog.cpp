@@ -1,10 +1,14 @@
 #include "../include/translationsettingsdialog.h"
+#include "requestscheduler.h"
 #include <QFormLayout>
 #include <QDialogButtonBox>
 #include <QSettings>
 #include <QLabel>
 #include <QVBoxLayout>
 #include <QGroupBox>
+#include <QHBoxLayout>
+#include <QFileDialog>
+#include <limits>
 
 TranslationSettingsDialog::TranslationSettingsDialog(QWidget *parent)
     : QDialog(parent) {
@@ -25,6 +29,67 @@ TranslationSettingsDialog::TranslationSettingsDialog(QWidget *parent)
 
     mainLayout->addWidget(engineGroup);
 
+    QGroupBox *shardingGroup = new QGroupBox("多引擎批量翻译", this);
+    QFormLayout *shardingLayout = new QFormLayout(shardingGroup);
+
+    m_shardingCheck = new QCheckBox("同时使用所有已配置密钥的引擎，按实际吞吐量分配工作", this);
+    shardingLayout->addRow(m_shardingCheck);
+
+    m_pinnedEngineCombo = new QComboBox(this);
+    m_pinnedEngineCombo->addItem("不固定", -1);
+    for (TranslationService::Engine engine : TranslationService::supportedEngines()) {
+        m_pinnedEngineCombo->addItem(TranslationService::engineName(engine), engine);
+    }
+    shardingLayout->addRow("固定引擎:", m_pinnedEngineCombo);
+
+    m_pinnedContextsEdit = new QLineEdit(this);
+    m_pinnedContextsEdit->setPlaceholderText("例如 MainWindow, *Dialog（逗号分隔，支持通配符）");
+    shardingLayout->addRow("固定上下文:", m_pinnedContextsEdit);
+
+    mainLayout->addWidget(shardingGroup);
+
+    QGroupBox *prefetchGroup = new QGroupBox("审阅预取", this);
+    QFormLayout *prefetchLayout = new QFormLayout(prefetchGroup);
+
+    m_prefetchCountSpin = new QSpinBox(this);
+    m_prefetchCountSpin->setRange(0, 20);
+    m_prefetchCountSpin->setSpecialValueText("关闭");
+    m_prefetchCountSpin->setSuffix(" 条");
+    m_prefetchCountSpin->setToolTip("选中条目后，在后台翻译同一上下文中随后的未完成条目");
+    prefetchLayout->addRow("预取条数:", m_prefetchCountSpin);
+
+    m_prefetchBudgetSpin = new QSpinBox(this);
+    m_prefetchBudgetSpin->setRange(0, std::numeric_limits<int>::max());
+    m_prefetchBudgetSpin->setSingleStep(1000);
+    m_prefetchBudgetSpin->setSuffix(" 字符");
+    m_prefetchBudgetSpin->setToolTip("每次运行中预取最多消耗的字符数");
+    prefetchLayout->addRow("预取额度:", m_prefetchBudgetSpin);
+
+    mainLayout->addWidget(prefetchGroup);
+
+    QGroupBox *phrasebookGroup = new QGroupBox("离线短语库", this);
+    QFormLayout *phrasebookLayout = new QFormLayout(phrasebookGroup);
+
+    m_phrasebooksEdit = new QLineEdit(this);
+    m_phrasebooksEdit->setPlaceholderText("Qt Linguist 短语库（.qph）或 CSV（原文,译文），分号分隔");
+    m_phrasebooksEdit->setToolTip("短语库中的文本直接使用其中的译文，只有未命中的文本才发送给翻译引擎");
+    QPushButton *browseButton = new QPushButton("浏览...", this);
+    connect(browseButton, &QPushButton::clicked, [this]{
+        QStringList files = QFileDialog::getOpenFileNames(this, "选择短语库", QString(),
+                                                          "短语库 (*.qph *.csv);;所有文件 (*)");
+        if (!files.isEmpty()) {
+            files = phrasebooks() + files;
+            files.removeDuplicates();
+            m_phrasebooksEdit->setText(files.join("; "));
+        }
+    });
+    QHBoxLayout *phrasebookRow = new QHBoxLayout;
+    phrasebookRow->addWidget(m_phrasebooksEdit, 1);
+    phrasebookRow->addWidget(browseButton);
+    phrasebookLayout->addRow("短语库文件:", phrasebookRow);
+
+    mainLayout->addWidget(phrasebookGroup);
+
     m_tabWidget = new QTabWidget(this);
 
     for (TranslationService::Engine engine : TranslationService::supportedEngines()) {
@@ -44,6 +109,15 @@ TranslationSettingsDialog::TranslationSettingsDialog(QWidget *parent)
     QSettings settings;
     int savedEngine = settings.value("Translation/currentEngine", TranslationService::GoogleTranslate).toInt();
     m_engineCombo->setCurrentIndex(m_engineCombo->findData(savedEngine));
+
+    m_shardingCheck->setChecked(settings.value("Translation/sharding", false).toBool());
+    int pinnedEngine = settings.value("Translation/pinnedEngine", -1).toInt();
+    m_pinnedEngineCombo->setCurrentIndex(qMax(0, m_pinnedEngineCombo->findData(pinnedEngine)));
+    m_pinnedContextsEdit->setText(settings.value("Translation/pinnedContexts").toStringList().join(", "));
+    m_prefetchCountSpin->setValue(settings.value("Translation/prefetchCount", 3).toInt());
+    qint64 prefetchBudget = settings.value("Translation/prefetchBudget", 20000).toLongLong();
+    m_prefetchBudgetSpin->setValue(static_cast<int>(qMin<qint64>(prefetchBudget, std::numeric_limits<int>::max())));
+    m_phrasebooksEdit->setText(settings.value("Translation/phrasebooks").toStringList().join("; "));
 }
 
 void TranslationSettingsDialog::setupEngineTab(TranslationService::Engine engine, const QString &name) {
@@ -77,6 +151,12 @@ void TranslationSettingsDialog::setupEngineTab(TranslationService::Engine engine
     formLayout->addRow("源语言:", settings.sourceLangCombo);
     formLayout->addRow("目标语言:", settings.targetLangCombo);
 
+    settings.quotaSpin = new QSpinBox(tab);
+    settings.quotaSpin->setRange(-1, std::numeric_limits<int>::max());
+    settings.quotaSpin->setSpecialValueText("不限");
+    settings.quotaSpin->setSuffix(" 字符");
+    formLayout->addRow("剩余额度:", settings.quotaSpin);
+
     QLabel *hintLabel = new QLabel(tab);
     switch (engine) {
         case TranslationService::BaiduTranslate:
@@ -105,6 +185,10 @@ void TranslationSettingsDialog::setupEngineTab(TranslationService::Engine engine
     QString targetLang = settingsStore.value(engineKey + "targetLang", "zh-CN").toString();
     int targetIndex = settings.targetLangCombo->findData(targetLang);
     if (targetIndex >= 0) settings.targetLangCombo->setCurrentIndex(targetIndex);
+
+    // 额度由调度器记录并延迟写入设置，直接读取当前值
+    qint64 quota = RequestScheduler::instance()->remainingQuota(engine);
+    settings.quotaSpin->setValue(static_cast<int>(qMin<qint64>(quota, std::numeric_limits<int>::max())));
 }
 
 TranslationService::Engine TranslationSettingsDialog::currentEngine() const {
@@ -121,4 +205,43 @@ QString TranslationSettingsDialog::sourceLanguage(TranslationService::Engine eng
 
 QString TranslationSettingsDialog::targetLanguage(TranslationService::Engine engine) const {
     return m_engineSettings.value(engine).targetLangCombo->currentData().toString();
-}
\ No newline at end of file
+}
+qint64 TranslationSettingsDialog::remainingQuota(TranslationService::Engine engine) const {
+    return m_engineSettings.value(engine).quotaSpin->value();
+}
+
+bool TranslationSettingsDialog::shardingEnabled() const {
+    return m_shardingCheck->isChecked();
+}
+
+int TranslationSettingsDialog::pinnedEngine() const {
+    return m_pinnedEngineCombo->currentData().toInt();
+}
+
+QStringList TranslationSettingsDialog::pinnedContexts() const {
+    QStringList patterns;
+    for (const QString &pattern : m_pinnedContextsEdit->text().split(',')) {
+        if (!pattern.trimmed().isEmpty()) {
+            patterns.append(pattern.trimmed());
+        }
+    }
+    return patterns;
+}
+
+int TranslationSettingsDialog::prefetchCount() const {
+    return m_prefetchCountSpin->value();
+}
+
+qint64 TranslationSettingsDialog::prefetchBudget() const {
+    return m_prefetchBudgetSpin->value();
+}
+
+QStringList TranslationSettingsDialog::phrasebooks() const {
+    QStringList files;
+    for (const QString &file : m_phrasebooksEdit->text().split(';')) {
+        if (!file.trimmed().isEmpty()) {
+            files.append(file.trimmed());
+        }
+    }
+    return files;
+}
@@ -1,58 +1,199 @@
 #include "tsfilehandler.h"
-
+#include "tracerecorder.h"
+#include "tssnapshot.h"
+#include "qmwriter.h"
+
+#include <QCryptographicHash>
+#include <QFileInfo>
+#include <QFileSystemWatcher>
+#include <QSet>
+#include <QTimer>
+#include <algorithm>
+#include <functional>
 #include <iostream>
+
+namespace {
+
+// 文件中一个 <context> 元素的原始字节范围
+struct ContextSpan {
+    QString name;
+    int begin;
+    int end;
+};
+
+QString decodeContextName(const QByteArray &content, int begin, int end) {
+    int nameBegin = content.indexOf("<name>", begin);
+    int nameEnd = nameBegin < 0 ? -1 : content.indexOf("</name>", nameBegin);
+    if (nameEnd < 0 || nameEnd > end) {
+        return QString();
+    }
+    QXmlStreamReader reader(content.mid(nameBegin, nameEnd + 7 - nameBegin));
+    reader.readNextStartElement();
+    return reader.readElementText();
+}
+
+// 按字节扫描上下文边界，不做完整的XML解析
+QList<ContextSpan> scanContexts(const QByteArray &content) {
+    QList<ContextSpan> spans;
+    int pos = 0;
+    while ((pos = content.indexOf("<context", pos)) >= 0) {
+        char next = pos + 8 < content.size() ? content.at(pos + 8) : '\0';
+        if (next != '>' && next != ' ' && next != '\t' && next != '\r' && next != '\n') {
+            pos += 8;
+            continue;
+        }
+        int end = content.indexOf("</context>", pos);
+        if (end < 0) {
+            break;
+        }
+        end += 10;
+        spans.append({decodeContextName(content, pos, end), pos, end});
+        pos = end;
+    }
+    return spans;
+}
+
+// 同名上下文出现多次时合并为一个哈希
+QHash<QString, QByteArray> hashContexts(const QByteArray &content, const QList<ContextSpan> &spans) {
+    QHash<QString, QByteArray> hashes;
+    for (const ContextSpan &span : spans) {
+        QCryptographicHash hash(QCryptographicHash::Md5);
+        hash.addData(hashes.value(span.name));
+        hash.addData(content.constData() + span.begin, span.end - span.begin);
+        hashes.insert(span.name, hash.result());
+    }
+    return hashes;
+}
+
+bool sameEntry(const TsEntry &a, const TsEntry &b) {
+    return a.translation == b.translation && a.state == b.state
+           && a.comments == b.comments && a.locations == b.locations;
+}
+
+} // namespace
+
 TsFileHandler::TsFileHandler(QObject *parent) : QObject(parent) {}
 
 bool TsFileHandler::load(const QString &filePath) {
+    TraceScope trace("TsFileHandler::load", "io");
+    trace.setDetail(filePath);
     m_entries.clear();
     m_filePath = filePath;
+    m_snapshotStale = false;
+    m_savedHash.clear();
+
+    // 快照与文件一致时直接使用，跳过XML解析
+    TsSnapshot::Catalog catalog;
+    if (TsSnapshot::load(filePath, catalog)) {
+        m_version = catalog.version;
+        m_language = catalog.language;
+        m_sourceLanguage = catalog.sourceLanguage;
+        m_entries.assign(catalog.entries);
+        rebuildIndexes();
+        // 快照不含上下文哈希，第一次外部修改时逐条比较全部上下文，
+        // 内存中有而文件中已删除的上下文也按变化处理
+        m_contextHashes.clear();
+        watchCurrentFile();
+        emit fileLoaded(true);
+        return true;
+    }
 
     QFile file(filePath);
-    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+    if (!file.open(QIODevice::ReadOnly)) {
+        rebuildIndexes();
         emit fileLoaded(false);
         return false;
     }
 
-    QXmlStreamReader reader(&file);
+    // 整个文件读入内存，解析后用同一份内容计算快照的哈希
+    const QByteArray content = file.readAll();
+    file.close();
+    QXmlStreamReader reader(content);
 
     // 解析XML
-    parseXml(reader);
-
-    file.close();
+    QList<TsEntry> entries;
+    parseXml(reader, entries);
+    m_entries.assign(entries);
+    rebuildIndexes();
 
     if (reader.hasError()) {
         emit fileLoaded(false);
         return false;
     }
 
+    m_contextHashes = hashContexts(content, scanContexts(content));
+    m_savedHash = TsSnapshot::contentHash(content);
+    watchCurrentFile();
+    writeSnapshot();
     emit fileLoaded(true);
     return true;
 }
 
-bool TsFileHandler::save(const QString &filePath) {
+bool TsFileHandler::save(const QString &filePath, bool updateSnapshot) {
+    TraceScope trace("TsFileHandler::save", "io");
     if (!filePath.isEmpty()) {
         m_filePath = filePath;
     }
 
     QFile file(m_filePath);
-    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+    if (!file.open(QIODevice::WriteOnly)) {
         emit fileSaved(false);
         return false;
     }
 
-    QXmlStreamWriter writer(&file);
+    QByteArray content;
+    QXmlStreamWriter writer(&content);
     writer.setAutoFormatting(true);
     writer.setAutoFormattingIndent(2);
 
     // 生成XML
     generateXml(writer);
 
+    // 按二进制写出，磁盘上的字节与计算哈希的内容一致（文本模式在 Windows 上会转换换行）
+    file.write(content);
     file.close();
 
+    // 保存后的内容即为新的基准，本次写入触发的文件通知不会产生任何合并
+    m_dirtyBits.clear();
+    m_contextHashes = hashContexts(content, scanContexts(content));
+    m_savedHash = TsSnapshot::contentHash(content);
+    watchCurrentFile();
+    if (updateSnapshot) {
+        writeSnapshot();
+    } else {
+        m_snapshotStale = true;
+    }
     emit fileSaved(true);
     return true;
 }
 
+bool TsFileHandler::release(const QString &qmPath) const {
+    TraceScope trace("TsFileHandler::release", "io");
+    trace.setDetail(qmPath);
+    return QmWriter::write(qmPath, m_language, m_entries.snapshot());
+}
+
+void TsFileHandler::flushSnapshot() {
+    // 保存后又有修改时，条目已与磁盘内容不一致，不能写入快照
+    if (m_snapshotStale && m_dirtyBits.count() == 0) {
+        writeSnapshot();
+    }
+}
+
+void TsFileHandler::writeSnapshot() {
+    m_snapshotStale = false;
+    if (!m_snapshotsEnabled || m_savedHash.isEmpty()) {
+        return;
+    }
+    TsSnapshot::Catalog catalog;
+    catalog.version = m_version;
+    catalog.language = m_language;
+    catalog.sourceLanguage = m_sourceLanguage;
+    catalog.entries = m_entries.toList();
+    // 写入失败（例如目录只读）不影响打开和保存，下次仍按XML解析
+    TsSnapshot::save(m_filePath, m_savedHash, catalog);
+}
+
 TsEntry TsFileHandler::entryAt(int index) const {
     if (index >= 0 && index < m_entries.size()) {
         return m_entries.at(index);
@@ -62,28 +203,94 @@ TsEntry TsFileHandler::entryAt(int index) const {
 
 void TsFileHandler::updateEntryTranslation(int index, const QString &translation) {
     if (index >= 0 && index < m_entries.size()) {
-        m_entries[index].translation = translation;
+        m_entries.update(index, [&translation](TsEntry &entry) {
+            entry.translation = translation;
+        });
+        m_emptyTranslationBits.set(index, translation.isEmpty());
+        m_dirtyBits.set(index);
         emit entryUpdated(index);
     }
 }
 
 void TsFileHandler::updateEntryState(int index, TranslationState state) {
     if (index >= 0 && index < m_entries.size()) {
-        m_entries[index].state = state;
+        setIndexedState(index, m_entries.at(index).state, state);
+        m_entries.update(index, [state](TsEntry &entry) {
+            entry.state = state;
+        });
+        m_dirtyBits.set(index);
         emit entryUpdated(index);
     }
 }
 
+void TsFileHandler::applyTranslations(QVector<TranslationUpdate> &&updates) {
+    TraceScope trace("TsFileHandler::applyTranslations", "apply");
+    const int count = m_entries.size();
+    updates.erase(std::remove_if(updates.begin(), updates.end(), [count](const TranslationUpdate &update) {
+        return update.index < 0 || update.index >= count;
+    }), updates.end());
+    if (updates.isEmpty()) {
+        return;
+    }
+
+    QVector<int> indices;
+    indices.reserve(updates.size());
+    int first = count;
+    int last = -1;
+    for (const TranslationUpdate &update : std::as_const(updates)) {
+        indices.append(update.index);
+        first = qMin(first, update.index);
+        last = qMax(last, update.index);
+    }
+
+    // 索引在同一遍中按条目的当前状态更新，同一条目出现多次时以最后一次为准
+    m_entries.updateMany(indices, [this, &updates](TsEntry &entry, int i) {
+        TranslationUpdate &update = updates[i];
+        setIndexedState(update.index, entry.state, update.state);
+        m_emptyTranslationBits.set(update.index, update.translation.isEmpty());
+        m_dirtyBits.set(update.index);
+        entry.translation = std::move(update.translation);
+        entry.state = update.state;
+    });
+    emit entriesUpdated(first, last);
+}
+
 void TsFileHandler::addEntry(const TsEntry &entry) {
     m_entries.append(entry);
+    for (int i = 0; i < 4; ++i) {
+        m_stateBits[i].append(static_cast<int>(entry.state) == i);
+    }
+    m_emptyTranslationBits.append(entry.translation.isEmpty());
+    m_dirtyBits.append(false);
     emit entryAdded(m_entries.size() - 1);
 }
 
-void TsFileHandler::removeEntry(int index) {
-    if (index >= 0 && index < m_entries.size()) {
-        m_entries.removeAt(index);
-        emit entryRemoved(index);
+void TsFileHandler::removeEntries(QVector<int> indices) {
+    std::sort(indices.begin(), indices.end());
+    indices.erase(std::unique(indices.begin(), indices.end()), indices.end());
+    const int size = m_entries.size();
+    indices.erase(std::remove_if(indices.begin(), indices.end(), [size](int index) {
+        return index < 0 || index >= size;
+    }), indices.end());
+    if (indices.isEmpty()) {
+        return;
+    }
+
+    m_entries.removeMany(indices);
+    for (EntryBitmap &bits : m_stateBits) {
+        bits.removeIndices(indices);
+    }
+    m_emptyTranslationBits.removeIndices(indices);
+    m_dirtyBits.removeIndices(indices);
+    emit entriesRemoved(indices);
+}
+
+int TsFileHandler::remapIndex(const QVector<int> &removed, int index) {
+    const auto it = std::lower_bound(removed.cbegin(), removed.cend(), index);
+    if (it != removed.cend() && *it == index) {
+        return -1;
     }
+    return index - static_cast<int>(it - removed.cbegin());
 }
 
 QList<int> TsFileHandler::findEntries(const QString &searchText, bool searchSource, bool searchTranslation) {
@@ -105,58 +312,381 @@ QList<int> TsFileHandler::findEntries(const QString &searchText, bool searchSour
 }
 
 QList<int> TsFileHandler::getUntranslatedEntries() {
+    return untranslatedBitmap().toList();
+}
+
+QList<int> TsFileHandler::findEntriesBySource(const QString &source) {
     QList<int> results;
+
     for (int i = 0; i < m_entries.size(); ++i) {
-        if (m_entries.at(i).state == TranslationState::Unfinished ||
-            m_entries.at(i).translation.isEmpty()) {
+        if (m_entries.at(i).source == source) {
             results.append(i);
         }
     }
+
     return results;
 }
 
-QList<int> TsFileHandler::findEntriesBySource(const QString &source) {
-    QList<int> results;
+QList<int> TsFileHandler::getNeedsReviewEntries() {
+    return needsReviewBitmap().toList();
+}
 
+TsFileHandler::Statistics TsFileHandler::getStatistics() const {
+    Statistics stats;
+    stats.totalEntries = m_entries.size();
+    stats.translated = stateBitmap(TranslationState::Finished).count();
+    stats.unfinished = stateBitmap(TranslationState::Unfinished).count();
+    stats.vanished = stateBitmap(TranslationState::Vanished).count();
+    stats.obsolete = stateBitmap(TranslationState::Obsolete).count();
+    return stats;
+}
+
+TsFileHandler::MergeReport TsFileHandler::mergeTranslations(const EntryStore &previous) {
+    TraceScope trace("TsFileHandler::mergeTranslations", "io");
+    MergeReport report;
+
+    // 建立两张哈希表：(上下文, 源文本) -> 旧条目，源文本 -> 有译文的旧条目
+    QHash<QPair<QString, QString>, QList<int>> byContext;
+    QHash<QString, QList<int>> bySource;
+    byContext.reserve(previous.size());
+    bySource.reserve(previous.size());
+    for (int i = 0; i < previous.size(); ++i) {
+        const TsEntry &entry = previous.at(i);
+        byContext[qMakePair(entry.context, entry.source)].append(i);
+        if (!entry.translation.isEmpty()) {
+            bySource[entry.source].append(i);
+        }
+    }
+
+    // 只更新被合并修改的条目的索引，合并前未保存的修改保留其修改标记
+    auto markMerged = [this](int index, TranslationState oldState) {
+        setIndexedState(index, oldState, m_entries.at(index).state);
+        m_emptyTranslationBits.set(index, m_entries.at(index).translation.isEmpty());
+        m_dirtyBits.set(index);
+    };
+
+    QVector<bool> matched(previous.size(), false);
     for (int i = 0; i < m_entries.size(); ++i) {
-        if (m_entries[i].source == source) {
-            results.append(i);
+        const TsEntry &entry = m_entries.at(i);
+
+        // 同一 (上下文, 源文本) 有多条时优先取注释相同的
+        int match = -1;
+        auto candidates = byContext.constFind(qMakePair(entry.context, entry.source));
+        if (candidates != byContext.constEnd()) {
+            for (int candidate : candidates.value()) {
+                if (matched.at(candidate)) continue;
+                if (match < 0) match = candidate;
+                if (previous.at(candidate).comments.value(0) == entry.comments.value(0)) {
+                    match = candidate;
+                    break;
+                }
+            }
+        }
+
+        if (match >= 0) {
+            matched[match] = true;
+            const TsEntry &old = previous.at(match);
+            if (old.translation.isEmpty()) {
+                ++report.untranslated;
+                continue;
+            }
+            if (!entry.translation.isEmpty()) {
+                if (entry.translation != old.translation) {
+                    report.conflicts.append({i, entry.context, entry.source, {entry.translation, old.translation}});
+                }
+                continue;
+            }
+            // 重新出现的废弃消息需要复核
+            const TranslationState oldState = entry.state;
+            m_entries.update(i, [&old](TsEntry &target) {
+                target.translation = old.translation;
+                target.state = (old.state == TranslationState::Obsolete || old.state == TranslationState::Vanished)
+                                   ? TranslationState::Unfinished : old.state;
+            });
+            markMerged(i, oldState);
+            ++report.exactMatches;
+            continue;
+        }
+
+        if (!entry.translation.isEmpty()) {
+            continue;
+        }
+
+        // 上下文改变：按源文本匹配，各处译文一致时才采用
+        auto sameSource = bySource.constFind(entry.source);
+        if (sameSource == bySource.constEnd()) {
+            ++report.untranslated;
+            continue;
+        }
+        QStringList translations;
+        for (int candidate : sameSource.value()) {
+            const QString &translation = previous.at(candidate).translation;
+            if (!translations.contains(translation)) {
+                translations.append(translation);
+            }
+        }
+        if (translations.size() > 1) {
+            report.conflicts.append({i, entry.context, entry.source, translations});
+            ++report.untranslated;
+            continue;
         }
+        const TranslationState oldState = entry.state;
+        m_entries.update(i, [&translations](TsEntry &target) {
+            target.translation = translations.first();
+            target.state = TranslationState::Unfinished;
+        });
+        markMerged(i, oldState);
+        ++report.sourceMatches;
     }
 
-    return results;
+    // 旧文件中有译文但未匹配到的消息保留下来，标记为 vanished（原本已废弃的保持 obsolete）
+    for (int i = 0; i < previous.size(); ++i) {
+        const TsEntry &old = previous.at(i);
+        if (matched.at(i) || old.translation.isEmpty()) {
+            continue;
+        }
+        TsEntry entry = old;
+        if (old.state == TranslationState::Obsolete) {
+            ++report.obsolete;
+        } else {
+            entry.state = TranslationState::Vanished;
+            ++report.vanished;
+        }
+        m_entries.append(entry);
+        for (int state = 0; state < 4; ++state) {
+            m_stateBits[state].append(static_cast<int>(entry.state) == state);
+        }
+        m_emptyTranslationBits.append(false);
+        m_dirtyBits.append(true);
+    }
+
+    emit entriesReset();
+    return report;
 }
 
-QList<int> TsFileHandler::getNeedsReviewEntries() {
-    QList<int> results;
+const EntryBitmap &TsFileHandler::stateBitmap(TranslationState state) const {
+    return m_stateBits[static_cast<int>(state)];
+}
 
+EntryBitmap TsFileHandler::untranslatedBitmap() const {
+    return stateBitmap(TranslationState::Unfinished) | m_emptyTranslationBits;
+}
+
+EntryBitmap TsFileHandler::needsReviewBitmap() const {
+    EntryBitmap result = stateBitmap(TranslationState::Unfinished);
+    return result.subtract(m_emptyTranslationBits);
+}
+
+int TsFileHandler::nextEntry(const EntryBitmap &set, int index, bool wrap) {
+    int next = set.nextSetBit(index + 1);
+    if (next < 0 && wrap) {
+        next = set.nextSetBit(0);
+    }
+    return next;
+}
+
+int TsFileHandler::previousEntry(const EntryBitmap &set, int index, bool wrap) {
+    // index 为 -1（当前没有选中条目）时从末尾开始
+    int previous = index < 0 ? -1 : set.previousSetBit(index - 1);
+    if (previous < 0 && wrap) {
+        previous = set.previousSetBit(set.size() - 1);
+    }
+    return previous;
+}
+
+void TsFileHandler::rebuildIndexes() {
+    const int count = m_entries.size();
+    for (EntryBitmap &bits : m_stateBits) {
+        bits.resize(count);
+        bits.clear();
+    }
+    m_emptyTranslationBits.resize(count);
+    m_emptyTranslationBits.clear();
+    m_dirtyBits.resize(count);
+    m_dirtyBits.clear();
+
+    for (int i = 0; i < count; ++i) {
+        const TsEntry &entry = m_entries.at(i);
+        m_stateBits[static_cast<int>(entry.state)].set(i);
+        if (entry.translation.isEmpty()) {
+            m_emptyTranslationBits.set(i);
+        }
+    }
+}
+
+void TsFileHandler::setIndexedState(int index, TranslationState oldState, TranslationState newState) {
+    m_stateBits[static_cast<int>(oldState)].reset(index);
+    m_stateBits[static_cast<int>(newState)].set(index);
+}
+
+void TsFileHandler::setWatching(bool enabled) {
+    if (!enabled) {
+        delete m_watcher;
+        m_watcher = nullptr;
+        return;
+    }
+    if (m_watcher) {
+        return;
+    }
+
+    m_watcher = new QFileSystemWatcher(this);
+    // lupdate 等工具可能分多次写入，等通知平息后再读取
+    m_reloadTimer = new QTimer(this);
+    m_reloadTimer->setSingleShot(true);
+    m_reloadTimer->setInterval(300);
+    connect(m_watcher, &QFileSystemWatcher::fileChanged, m_reloadTimer, QOverload<>::of(&QTimer::start));
+    connect(m_reloadTimer, &QTimer::timeout, this, &TsFileHandler::reloadChangedContexts);
+    watchCurrentFile();
+}
+
+void TsFileHandler::watchCurrentFile() {
+    if (!m_watcher) {
+        return;
+    }
+    const QStringList watched = m_watcher->files();
+    if (watched.size() == 1 && watched.first() == m_filePath) {
+        return;
+    }
+    if (!watched.isEmpty()) {
+        m_watcher->removePaths(watched);
+    }
+    if (!m_filePath.isEmpty() && QFileInfo::exists(m_filePath)) {
+        m_watcher->addPath(m_filePath);
+    }
+}
+
+void TsFileHandler::reloadChangedContexts() {
+    TraceScope trace("TsFileHandler::reloadChangedContexts", "io");
+    // 以改名方式替换文件后原监视会失效，重新加入
+    watchCurrentFile();
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        return;
+    }
+    const QByteArray content = file.readAll();
+    file.close();
+    // 写入尚未完成，等待下一次通知
+    if (!content.contains("</TS>")) {
+        return;
+    }
+
+    // 根元素的属性（语言、版本）总是重新读取
+    QXmlStreamReader header(content);
+    if (header.readNextStartElement() && header.name() == QLatin1String("TS")) {
+        m_version = header.attributes().value("version").toString();
+        m_language = header.attributes().value("language").toString();
+        m_sourceLanguage = header.attributes().value("sourcelanguage").toString();
+    }
+
+    const QList<ContextSpan> spans = scanContexts(content);
+    const QHash<QString, QByteArray> hashes = hashContexts(content, spans);
+    QSet<QString> changed;
+    for (auto it = hashes.constBegin(); it != hashes.constEnd(); ++it) {
+        if (m_contextHashes.value(it.key()) != it.value()) {
+            changed.insert(it.key());
+        }
+    }
+    for (auto it = m_contextHashes.constBegin(); it != m_contextHashes.constEnd(); ++it) {
+        if (!hashes.contains(it.key())) {
+            changed.insert(it.key());
+        }
+    }
+    // 从快照载入时没有上下文哈希：文件中已不存在的上下文只能从内存中的条目得知
+    if (m_contextHashes.isEmpty()) {
+        for (const TsEntry &entry : m_entries) {
+            if (!hashes.contains(entry.context)) {
+                changed.insert(entry.context);
+            }
+        }
+    }
+    if (changed.isEmpty()) {
+        return;
+    }
+
+    // 先解析全部变化的上下文，任何一处出错都不修改现有条目
+    QHash<QString, QList<TsEntry>> incoming;
+    for (const ContextSpan &span : spans) {
+        if (!changed.contains(span.name)) {
+            continue;
+        }
+        QXmlStreamReader reader(QByteArray::fromRawData(content.constData() + span.begin, span.end - span.begin));
+        parseXml(reader, incoming[span.name]);
+        if (reader.hasError()) {
+            return;
+        }
+    }
+
+    QHash<QString, QList<int>> current;
     for (int i = 0; i < m_entries.size(); ++i) {
-        if (m_entries.at(i).state == TranslationState::Unfinished &&
-            !m_entries.at(i).translation.isEmpty()) {
-            results.append(i);
+        if (changed.contains(m_entries.at(i).context)) {
+            current[m_entries.at(i).context].append(i);
         }
     }
 
-    return results;
+    int updated = 0;
+    int added = 0;
+    QList<int> removed;
+    for (const QString &context : std::as_const(changed)) {
+        mergeContext(current.value(context), incoming.value(context), updated, added, removed);
+    }
+
+    removeEntries(QVector<int>(removed.cbegin(), removed.cend()));
+
+    m_contextHashes = hashes;
+    emit externalChangesMerged(updated, added, removed.size());
 }
 
-TsFileHandler::Statistics TsFileHandler::getStatistics() const {
-    Statistics stats;
-    stats.totalEntries = m_entries.size();
+void TsFileHandler::mergeContext(const QList<int> &current, const QList<TsEntry> &incoming,
+                                 int &updated, int &added, QList<int> &removed) {
+    // 按 (源文本, 注释) 配对，重复的消息按出现顺序配对
+    QHash<QPair<QString, QString>, QList<int>> existing;
+    for (int index : current) {
+        const TsEntry &entry = m_entries.at(index);
+        existing[qMakePair(entry.source, entry.comments.value(0))].append(index);
+    }
 
-    for (const TsEntry &entry : m_entries) {
-        switch (entry.state) {
-        case TranslationState::Finished: stats.translated++; break;
-        case TranslationState::Unfinished: stats.unfinished++; break;
-        case TranslationState::Vanished: stats.vanished++; break;
-        case TranslationState::Obsolete: stats.obsolete++; break;
+    for (const TsEntry &entry : incoming) {
+        auto match = existing.find(qMakePair(entry.source, entry.comments.value(0)));
+        if (match == existing.end() || match.value().isEmpty()) {
+            // 新消息追加到末尾，已有条目的下标不变；保存时按上下文分组写出
+            addEntry(entry);
+            ++added;
+            continue;
+        }
+
+        int index = match.value().takeFirst();
+        TsEntry merged = entry;
+        if (m_dirtyBits.test(index)) {
+            // 保留未保存的本地修改，只采用新的位置与注释
+            merged.translation = m_entries.at(index).translation;
+            merged.state = m_entries.at(index).state;
+        }
+        if (!sameEntry(merged, m_entries.at(index))) {
+            replaceEntry(index, merged);
+            ++updated;
         }
     }
 
-    return stats;
+    // 文件中已不存在的消息：未修改的移除，有本地修改的保留
+    for (auto it = existing.constBegin(); it != existing.constEnd(); ++it) {
+        for (int index : it.value()) {
+            if (!m_dirtyBits.test(index)) {
+                removed.append(index);
+            }
+        }
+    }
 }
 
-void TsFileHandler::parseXml(QXmlStreamReader &reader) {
+void TsFileHandler::replaceEntry(int index, const TsEntry &entry) {
+    setIndexedState(index, m_entries.at(index).state, entry.state);
+    m_emptyTranslationBits.set(index, entry.translation.isEmpty());
+    m_entries.replace(index, entry);
+    emit entryUpdated(index);
+}
+
+void TsFileHandler::parseXml(QXmlStreamReader &reader, QList<TsEntry> &entries) {
+    TraceScope trace("TsFileHandler::parseXml", "io");
     while (!reader.atEnd() && !reader.hasError()) {
         QXmlStreamReader::TokenType token = reader.readNext();
 
@@ -178,33 +708,8 @@ void TsFileHandler::parseXml(QXmlStreamReader &reader) {
                         } else if (reader.name() == "message") {
                             TsEntry entry;
                             entry.context = contextName;
-
-                            while (!(reader.tokenType() == QXmlStreamReader::EndElement &&
-                                     reader.name() == "message")) {
-                                if (reader.tokenType() == QXmlStreamReader::StartElement) {
-                                    if (reader.name() == "source") {
-                                        entry.source = reader.readElementText();
-                                    } else if (reader.name() == "translation") {
-                                        QXmlStreamAttributes attrs = reader.attributes();
-                                        if (attrs.hasAttribute("type")) {
-                                            entry.state = stringToState(attrs.value("type").toString());
-                                        } else {
-                                            entry.state = TranslationState::Finished;
-                                        }
-                                        entry.translation = reader.readElementText();
-                                    } else if (reader.name() == "comment") {
-                                        entry.comments.append(reader.readElementText());
-                                    } else if (reader.name() == "location") {
-                                        QXmlStreamAttributes attrs = reader.attributes();
-                                        QString location = attrs.value("filename").toString() +
-                                                           ":" + attrs.value("line").toString();
-                                        entry.locations.append(location);
-                                        reader.readNext(); // Skip to end of location
-                                    }
-                                }
-                                reader.readNext();
-                            }
-                            m_entries.append(entry);
+                            readMessage(reader, entry);
+                            entries.append(entry);
                         }
                     }
                     reader.readNext();
@@ -231,27 +736,7 @@ void TsFileHandler::generateXml(QXmlStreamWriter &writer) {
         writer.writeStartElement("context");
         writer.writeTextElement("name", it.key());
         for (const TsEntry &entry : it.value()) {
-            writer.writeStartElement("message");
-            for (const QString &location : entry.locations) {
-                QStringList parts = location.split(":");
-                if (parts.size() >= 2) {
-                    writer.writeStartElement("location");
-                    writer.writeAttribute("filename", parts[0]);
-                    writer.writeAttribute("line", parts[1]);
-                    writer.writeEndElement(); // location
-                }
-            }
-            for (const QString &comment : entry.comments) {
-                writer.writeTextElement("comment", comment);
-            }
-            writer.writeTextElement("source", entry.source);
-            writer.writeStartElement("translation");
-            if (entry.state != TranslationState::Finished) {
-                writer.writeAttribute("type", stateToString(entry.state));
-            }
-            writer.writeCharacters(entry.translation);
-            writer.writeEndElement(); // translation
-            writer.writeEndElement(); // message
+            writeMessage(writer, entry);
         }
         writer.writeEndElement(); // context
     }
@@ -259,7 +744,56 @@ void TsFileHandler::generateXml(QXmlStreamWriter &writer) {
     writer.writeEndDocument();
 }
 
-QString TsFileHandler::stateToString(TranslationState state) const {
+void TsFileHandler::readMessage(QXmlStreamReader &reader, TsEntry &entry) {
+    while (!reader.atEnd() && !reader.hasError()) {
+        QXmlStreamReader::TokenType token = reader.readNext();
+        if (token == QXmlStreamReader::EndElement && reader.name() == QLatin1String("message")) {
+            break;
+        }
+        if (token != QXmlStreamReader::StartElement) {
+            continue;
+        }
+        if (reader.name() == QLatin1String("source")) {
+            entry.source = reader.readElementText();
+        } else if (reader.name() == QLatin1String("translation")) {
+            QXmlStreamAttributes attrs = reader.attributes();
+            entry.state = attrs.hasAttribute("type") ? stringToState(attrs.value("type").toString())
+                                                     : TranslationState::Finished;
+            entry.translation = reader.readElementText();
+        } else if (reader.name() == QLatin1String("comment")) {
+            entry.comments.append(reader.readElementText());
+        } else if (reader.name() == QLatin1String("location")) {
+            QXmlStreamAttributes attrs = reader.attributes();
+            entry.locations.append(attrs.value("filename").toString() + ":" + attrs.value("line").toString());
+        }
+    }
+}
+
+void TsFileHandler::writeMessage(QXmlStreamWriter &writer, const TsEntry &entry) {
+    writer.writeStartElement("message");
+    for (const QString &location : entry.locations) {
+        QStringList parts = location.split(":");
+        if (parts.size() >= 2) {
+            writer.writeStartElement("location");
+            writer.writeAttribute("filename", parts[0]);
+            writer.writeAttribute("line", parts[1]);
+            writer.writeEndElement(); // location
+        }
+    }
+    for (const QString &comment : entry.comments) {
+        writer.writeTextElement("comment", comment);
+    }
+    writer.writeTextElement("source", entry.source);
+    writer.writeStartElement("translation");
+    if (entry.state != TranslationState::Finished) {
+        writer.writeAttribute("type", stateToString(entry.state));
+    }
+    writer.writeCharacters(entry.translation);
+    writer.writeEndElement(); // translation
+    writer.writeEndElement(); // message
+}
+
+QString TsFileHandler::stateToString(TranslationState state) {
     switch (state) {
     case TranslationState::Unfinished: return "unfinished";
     case TranslationState::Vanished: return "vanished";
@@ -268,7 +802,7 @@ QString TsFileHandler::stateToString(TranslationState state) const {
     }
 }
 
-TranslationState TsFileHandler::stringToState(const QString &stateStr) const {
+TranslationState TsFileHandler::stringToState(const QString &stateStr) {
     if (stateStr == "unfinished") return TranslationState::Unfinished;
     if (stateStr == "vanished") return TranslationState::Vanished;
     if (stateStr == "obsolete") return TranslationState::Obsolete;
@@ -296,8 +830,13 @@ TsEntry TsFileHandler::findEntry(const QString &contextName, const QString &sour
 
 void TsFileHandler::updateEntryTranslation(const QString &contextName, const QString &source, const QString &translation) {
     for (int i = 0; i < m_entries.size(); ++i) {
-        if (m_entries[i].context == contextName && m_entries[i].source == source) {
-            m_entries[i].translation = translation;
+        if (m_entries.at(i).context == contextName && m_entries.at(i).source == source) {
+            m_entries.update(i, [&translation](TsEntry &entry) {
+                entry.translation = translation;
+            });
+            m_emptyTranslationBits.set(i, translation.isEmpty());
+            m_dirtyBits.set(i);
+            emit entryUpdated(i);
             break;
         }
     }
@@ -305,8 +844,13 @@ void TsFileHandler::updateEntryTranslation(const QString &contextName, const QSt
 
 void TsFileHandler::updateEntryState(const QString &contextName, const QString &source, TranslationState state) {
     for (int i = 0; i < m_entries.size(); ++i) {
-        if (m_entries[i].context == contextName && m_entries[i].source == source) {
-            m_entries[i].state = state;
+        if (m_entries.at(i).context == contextName && m_entries.at(i).source == source) {
+            setIndexedState(i, m_entries.at(i).state, state);
+            m_entries.update(i, [state](TsEntry &entry) {
+                entry.state = state;
+            });
+            m_dirtyBits.set(i);
+            emit entryUpdated(i);
             break;
         }
     }
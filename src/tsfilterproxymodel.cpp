@@ -0,0 +1,83 @@
+#include "tsfilterproxymodel.h"
+
+TsFilterProxyModel::TsFilterProxyModel(QObject *parent)
+    : QSortFilterProxyModel(parent) {
+    setDynamicSortFilter(true);
+}
+
+TsTreeModel *TsFilterProxyModel::treeModel() const {
+    return qobject_cast<TsTreeModel *>(sourceModel());
+}
+
+void TsFilterProxyModel::setStateFilter(TsTreeModel::Filter filter) {
+    if (m_stateFilter == filter) {
+        return;
+    }
+    m_stateFilter = filter;
+    invalidateFilter();
+}
+
+void TsFilterProxyModel::setContextFilter(const QString &pattern) {
+    if (m_contextFilter == pattern) {
+        return;
+    }
+    m_contextFilter = pattern;
+    invalidateFilter();
+}
+
+void TsFilterProxyModel::setSortMode(SortMode mode) {
+    if (m_sortMode == mode) {
+        return;
+    }
+    m_sortMode = mode;
+    if (mode == FileOrder) {
+        // 恢复源模型顺序
+        sort(-1);
+    } else {
+        sort(1, Qt::AscendingOrder);
+    }
+}
+
+void TsFilterProxyModel::fetchMore(const QModelIndex &parent) {
+    // 新加载的行可能全部被筛掉，继续加载直到有可见行或已全部加载
+    QModelIndex sourceParent = mapToSource(parent);
+    int before = rowCount(parent);
+    do {
+        sourceModel()->fetchMore(sourceParent);
+    } while (rowCount(parent) == before && sourceModel()->canFetchMore(sourceParent));
+}
+
+bool TsFilterProxyModel::filterAcceptsRow(int sourceRow, const QModelIndex &sourceParent) const {
+    TsTreeModel *model = treeModel();
+    if (!model) {
+        return true;
+    }
+
+    if (!sourceParent.isValid()) {
+        if (!m_contextFilter.isEmpty()) {
+            QString name = model->contextName(model->index(sourceRow, 0));
+            if (!name.contains(m_contextFilter, Qt::CaseInsensitive)) {
+                return false;
+            }
+        }
+        return model->contextMatchCount(sourceRow, m_stateFilter) > 0;
+    }
+
+    if (m_stateFilter == TsTreeModel::AllEntries) {
+        return true;
+    }
+    int entry = model->entryIndex(model->index(sourceRow, 0, sourceParent));
+    return entry >= 0 && TsTreeModel::entryMatches(model->entryAt(entry), m_stateFilter);
+}
+
+bool TsFilterProxyModel::lessThan(const QModelIndex &left, const QModelIndex &right) const {
+    if (m_sortMode == SourceLength && left.parent().isValid()) {
+        int leftLength = left.data(TsTreeModel::SourceLengthRole).toInt();
+        int rightLength = right.data(TsTreeModel::SourceLengthRole).toInt();
+        if (leftLength != rightLength) {
+            return leftLength < rightLength;
+        }
+    }
+    // 上下文行和长度相同的消息保持文件顺序
+    return left.row() < right.row();
+}
@@ -0,0 +1,295 @@
+#include "tssnapshot.h"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QSaveFile>
+#include <QVector>
+#include <QtEndian>
+#include <cstring>
+#include "tracerecorder.h"
+
+namespace {
+
+const char Magic[8] = {'Q', 'T', 'S', 'S', 'N', 'A', 'P', '\0'};
+const quint32 FormatVersion = 2;
+const qint64 HeaderSize = 64;
+const qint64 RecordSize = 32;       // 每条目 8 个 quint32
+
+// 头部字段偏移
+enum HeaderField {
+    VersionOffset = 8,              // quint32 格式版本
+    EntryCountOffset = 12,          // quint32 条目数
+    FileSizeOffset = 16,            // quint64 TS文件大小
+    ModifiedOffset = 24,            // qint64  TS文件修改时间（毫秒）
+    HashOffset = 32,                // 16字节  TS文件内容的MD5
+    StringCountOffset = 48,         // quint32 字符串数，前三个为 version/language/sourcelanguage
+    ListCountOffset = 52            // quint32 列表表长度（注释与位置的字符串ID）
+};
+
+// 条目记录字段
+enum RecordField {
+    ContextField, SourceField, TranslationField, StateField,
+    FirstCommentField, CommentCountField, FirstLocationField, LocationCountField
+};
+
+quint32 readU32(const uchar *p) {
+    return qFromLittleEndian<quint32>(p);
+}
+
+void appendU32(QByteArray &out, quint32 value) {
+    uchar buffer[4];
+    qToLittleEndian<quint32>(value, buffer);
+    out.append(reinterpret_cast<const char *>(buffer), 4);
+}
+
+void appendUtf16(QByteArray &out, const QString &text) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    out.append(reinterpret_cast<const char *>(text.utf16()), text.size() * 2);
+#else
+    for (QChar c : text) {
+        uchar buffer[2];
+        qToLittleEndian<quint16>(c.unicode(), buffer);
+        out.append(reinterpret_cast<const char *>(buffer), 2);
+    }
+#endif
+}
+
+QString readUtf16(const uchar *p, int length) {
+#if Q_BYTE_ORDER == Q_LITTLE_ENDIAN
+    // 字符区按4字节对齐，可以直接整段复制
+    return QString(reinterpret_cast<const QChar *>(p), length);
+#else
+    QString text(length, Qt::Uninitialized);
+    for (int i = 0; i < length; ++i) {
+        text[i] = QChar(qFromLittleEndian<quint16>(p + i * 2));
+    }
+    return text;
+#endif
+}
+
+// 写入端的字符串去重表，相同文本只存一份
+class StringTable {
+public:
+    quint32 add(const QString &text) {
+        auto it = m_ids.constFind(text);
+        if (it != m_ids.constEnd()) {
+            return it.value();
+        }
+        quint32 id = m_strings.size();
+        m_ids.insert(text, id);
+        m_strings.append(text);
+        return id;
+    }
+    // 不参与去重，保证得到下一个ID；用于位置固定的头部字符串
+    quint32 append(const QString &text) {
+        m_strings.append(text);
+        return m_strings.size() - 1;
+    }
+    const QVector<QString> &strings() const { return m_strings; }
+
+private:
+    QHash<QString, quint32> m_ids;
+    QVector<QString> m_strings;
+};
+
+bool readList(const uchar *lists, quint32 first, quint32 count, quint32 listCount,
+              const QVector<QString> &strings, QStringList &result) {
+    if (static_cast<quint64>(first) + count > listCount) {
+        return false;
+    }
+    for (quint32 i = first; i < first + count; ++i) {
+        quint32 id = readU32(lists + i * 4);
+        if (id >= static_cast<quint32>(strings.size())) {
+            return false;
+        }
+        result.append(strings.at(id));
+    }
+    return true;
+}
+
+} // namespace
+
+QString TsSnapshot::snapshotPath(const QString &tsPath) {
+    return tsPath + ".snapshot";
+}
+
+QByteArray TsSnapshot::contentHash(const QByteArray &content) {
+    return QCryptographicHash::hash(content, QCryptographicHash::Md5);
+}
+
+bool TsSnapshot::load(const QString &tsPath, Catalog &catalog) {
+    TraceScope trace("TsSnapshot::load", "io");
+    QFileInfo tsInfo(tsPath);
+    QFile file(snapshotPath(tsPath));
+    if (!tsInfo.exists() || !file.open(QIODevice::ReadOnly) || file.size() < HeaderSize) {
+        return false;
+    }
+
+    const qint64 size = file.size();
+    const uchar *data = file.map(0, size);
+    if (!data) {
+        return false;
+    }
+
+    if (std::memcmp(data, Magic, sizeof(Magic)) != 0 || readU32(data + VersionOffset) != FormatVersion
+        || qFromLittleEndian<quint64>(data + FileSizeOffset) != static_cast<quint64>(tsInfo.size())) {
+        return false;
+    }
+
+    // 修改时间不同（例如版本库重新检出）但内容可能没变，此时比较内容哈希
+    const qint64 modified = tsInfo.lastModified().toMSecsSinceEpoch();
+    bool refreshModified = false;
+    if (qFromLittleEndian<qint64>(data + ModifiedOffset) != modified) {
+        QFile tsFile(tsPath);
+        QByteArray storedHash(reinterpret_cast<const char *>(data + HashOffset), 16);
+        if (!tsFile.open(QIODevice::ReadOnly) || contentHash(tsFile.readAll()) != storedHash) {
+            return false;
+        }
+        refreshModified = true;
+    }
+
+    const quint32 entryCount = readU32(data + EntryCountOffset);
+    const quint32 stringCount = readU32(data + StringCountOffset);
+    const quint32 listCount = readU32(data + ListCountOffset);
+    const qint64 charsOffset = HeaderSize + (static_cast<qint64>(stringCount) + 1) * 4
+                               + static_cast<qint64>(entryCount) * RecordSize
+                               + static_cast<qint64>(listCount) * 4;
+    if (stringCount < 3 || charsOffset > size) {
+        return false;
+    }
+
+    const uchar *offsets = data + HeaderSize;
+    const uchar *records = offsets + (static_cast<qint64>(stringCount) + 1) * 4;
+    const uchar *lists = records + static_cast<qint64>(entryCount) * RecordSize;
+    const uchar *chars = data + charsOffset;
+    const quint32 charCount = readU32(offsets + static_cast<qint64>(stringCount) * 4);
+    if (charsOffset + static_cast<qint64>(charCount) * 2 != size) {
+        return false;
+    }
+
+    // 字符串复制出映射区，之后改写TS文件或快照都不会影响已加载的条目
+    QVector<QString> strings(stringCount);
+    quint32 begin = readU32(offsets);
+    for (quint32 i = 0; i < stringCount; ++i) {
+        quint32 end = readU32(offsets + (static_cast<qint64>(i) + 1) * 4);
+        if (end < begin || end > charCount) {
+            return false;
+        }
+        strings[i] = readUtf16(chars + static_cast<qint64>(begin) * 2, end - begin);
+        begin = end;
+    }
+
+    QList<TsEntry> entries;
+    entries.reserve(entryCount);
+    for (quint32 i = 0; i < entryCount; ++i) {
+        const uchar *record = records + static_cast<qint64>(i) * RecordSize;
+        quint32 fields[8];
+        for (int field = 0; field < 8; ++field) {
+            fields[field] = readU32(record + field * 4);
+        }
+        if (fields[ContextField] >= stringCount || fields[SourceField] >= stringCount
+            || fields[TranslationField] >= stringCount
+            || fields[StateField] > static_cast<quint32>(TranslationState::Obsolete)) {
+            return false;
+        }
+
+        TsEntry entry;
+        entry.context = strings.at(fields[ContextField]);
+        entry.source = strings.at(fields[SourceField]);
+        entry.translation = strings.at(fields[TranslationField]);
+        entry.state = static_cast<TranslationState>(fields[StateField]);
+        if (!readList(lists, fields[FirstCommentField], fields[CommentCountField], listCount, strings, entry.comments)
+            || !readList(lists, fields[FirstLocationField], fields[LocationCountField], listCount, strings, entry.locations)) {
+            return false;
+        }
+        entries.append(entry);
+    }
+    file.unmap(const_cast<uchar *>(data));
+    file.close();
+
+    catalog.version = strings.at(0);
+    catalog.language = strings.at(1);
+    catalog.sourceLanguage = strings.at(2);
+    catalog.entries = entries;
+
+    // 内容未变，更新记录的修改时间，下次打开无需再计算哈希
+    if (refreshModified && file.open(QIODevice::ReadWrite) && file.seek(ModifiedOffset)) {
+        uchar buffer[8];
+        qToLittleEndian<qint64>(modified, buffer);
+        file.write(reinterpret_cast<const char *>(buffer), 8);
+    }
+    return true;
+}
+
+bool TsSnapshot::save(const QString &tsPath, const QByteArray &contentHash, const Catalog &catalog) {
+    TraceScope trace("TsSnapshot::save", "io");
+    QFileInfo tsInfo(tsPath);
+    if (!tsInfo.exists() || contentHash.size() != 16) {
+        return false;
+    }
+
+    // 头部三个字符串固定占用ID 0/1/2，即使彼此相同（例如都为空）也各存一份
+    StringTable strings;
+    strings.append(catalog.version);
+    strings.append(catalog.language);
+    strings.append(catalog.sourceLanguage);
+
+    QByteArray records;
+    records.reserve(catalog.entries.size() * RecordSize);
+    QByteArray lists;
+    quint32 listCount = 0;
+    for (const TsEntry &entry : catalog.entries) {
+        appendU32(records, strings.add(entry.context));
+        appendU32(records, strings.add(entry.source));
+        appendU32(records, strings.add(entry.translation));
+        appendU32(records, static_cast<quint32>(entry.state));
+        appendU32(records, listCount);
+        appendU32(records, entry.comments.size());
+        for (const QString &comment : entry.comments) {
+            appendU32(lists, strings.add(comment));
+        }
+        listCount += entry.comments.size();
+        appendU32(records, listCount);
+        appendU32(records, entry.locations.size());
+        for (const QString &location : entry.locations) {
+            appendU32(lists, strings.add(location));
+        }
+        listCount += entry.locations.size();
+    }
+
+    QByteArray offsets;
+    QByteArray chars;
+    quint32 charCount = 0;
+    for (const QString &text : strings.strings()) {
+        appendU32(offsets, charCount);
+        appendUtf16(chars, text);
+        charCount += text.size();
+    }
+    appendU32(offsets, charCount);
+
+    QByteArray header(HeaderSize, '\0');
+    uchar *headerData = reinterpret_cast<uchar *>(header.data());
+    std::memcpy(headerData, Magic, sizeof(Magic));
+    qToLittleEndian<quint32>(FormatVersion, headerData + VersionOffset);
+    qToLittleEndian<quint32>(catalog.entries.size(), headerData + EntryCountOffset);
+    qToLittleEndian<quint64>(tsInfo.size(), headerData + FileSizeOffset);
+    qToLittleEndian<qint64>(tsInfo.lastModified().toMSecsSinceEpoch(), headerData + ModifiedOffset);
+    std::memcpy(headerData + HashOffset, contentHash.constData(), 16);
+    qToLittleEndian<quint32>(strings.strings().size(), headerData + StringCountOffset);
+    qToLittleEndian<quint32>(listCount, headerData + ListCountOffset);
+
+    // 先写临时文件再替换，中途失败不会留下残缺的快照
+    QSaveFile file(snapshotPath(tsPath));
+    if (!file.open(QIODevice::WriteOnly)) {
+        return false;
+    }
+    file.write(header);
+    file.write(offsets);
+    file.write(records);
+    file.write(lists);
+    file.write(chars);
+    return file.commit();
+}
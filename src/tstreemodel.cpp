@@ -0,0 +1,448 @@
+#include "tstreemodel.h"
+
+#include <QColor>
+#include <QMap>
+#include "tracerecorder.h"
+
+#include <algorithm>
+#include <utility>
+
+TsTreeModel::TsTreeModel(TsFileHandler *fileHandler, QObject *parent)
+    : QAbstractItemModel(parent), m_fileHandler(fileHandler) {
+    connect(m_fileHandler, &TsFileHandler::fileLoaded, this, &TsTreeModel::rebuild);
+    connect(m_fileHandler, &TsFileHandler::entriesReset, this, &TsTreeModel::rebuild);
+    connect(m_fileHandler, &TsFileHandler::entryUpdated, this, &TsTreeModel::onEntryUpdated);
+    connect(m_fileHandler, &TsFileHandler::entriesUpdated, this, &TsTreeModel::onEntriesUpdated);
+    connect(m_fileHandler, &TsFileHandler::entryAdded, this, &TsTreeModel::onEntryAdded);
+    connect(m_fileHandler, &TsFileHandler::entriesRemoved, this, &TsTreeModel::onEntriesRemoved);
+}
+
+void TsTreeModel::rebuild() {
+    TraceScope trace("TsTreeModel::rebuild", "ui");
+    beginResetModel();
+
+    m_contexts.clear();
+    m_contextRows.clear();
+    const EntryStore &entries = m_fileHandler->entries();
+    m_entryContext.resize(entries.size());
+    m_entryRow.resize(entries.size());
+
+    // 只建立上下文分组（整数下标），不复制任何文本
+    for (int i = 0; i < entries.size(); ++i) {
+        const TsEntry &entry = entries.at(i);
+        auto it = m_contextRows.find(entry.context);
+        if (it == m_contextRows.end()) {
+            it = m_contextRows.insert(entry.context, m_contexts.size());
+            ContextNode node;
+            node.name = entry.context;
+            m_contexts.append(node);
+        }
+
+        ContextNode &node = m_contexts[it.value()];
+        m_entryContext[i] = it.value();
+        m_entryRow[i] = node.entries.size();
+        node.entries.append(i);
+    }
+
+    for (ContextNode &node : m_contexts) {
+        countContext(node);
+    }
+
+    endResetModel();
+}
+
+QModelIndex TsTreeModel::index(int row, int column, const QModelIndex &parent) const {
+    if (row < 0 || column < 0 || column >= 3) {
+        return QModelIndex();
+    }
+    if (!parent.isValid()) {
+        return row < m_contexts.size() ? createIndex(row, column, quintptr(0)) : QModelIndex();
+    }
+    if (!isContext(parent) || row >= m_contexts.at(parent.row()).fetched) {
+        return QModelIndex();
+    }
+    // 消息行的 internalId 保存所属上下文行号 + 1
+    return createIndex(row, column, quintptr(parent.row() + 1));
+}
+
+QModelIndex TsTreeModel::parent(const QModelIndex &child) const {
+    if (!child.isValid() || child.internalId() == 0) {
+        return QModelIndex();
+    }
+    return createIndex(static_cast<int>(child.internalId() - 1), 0, quintptr(0));
+}
+
+int TsTreeModel::rowCount(const QModelIndex &parent) const {
+    if (!parent.isValid()) {
+        return m_contexts.size();
+    }
+    if (isContext(parent) && parent.column() == 0) {
+        return m_contexts.at(parent.row()).fetched;
+    }
+    return 0;
+}
+
+int TsTreeModel::columnCount(const QModelIndex &) const {
+    return 3;
+}
+
+bool TsTreeModel::hasChildren(const QModelIndex &parent) const {
+    if (!parent.isValid()) {
+        return !m_contexts.isEmpty();
+    }
+    return isContext(parent) && parent.column() == 0 && !m_contexts.at(parent.row()).entries.isEmpty();
+}
+
+bool TsTreeModel::canFetchMore(const QModelIndex &parent) const {
+    if (!isContext(parent)) {
+        return false;
+    }
+    const ContextNode &node = m_contexts.at(parent.row());
+    return node.fetched < node.entries.size();
+}
+
+void TsTreeModel::fetchMore(const QModelIndex &parent) {
+    if (!canFetchMore(parent)) {
+        return;
+    }
+    ContextNode &node = m_contexts[parent.row()];
+    int count = qMin(FetchChunkSize, node.entries.size() - node.fetched);
+    beginInsertRows(parent.sibling(parent.row(), 0), node.fetched, node.fetched + count - 1);
+    node.fetched += count;
+    endInsertRows();
+}
+
+bool TsTreeModel::isContext(const QModelIndex &index) const {
+    return index.isValid() && index.internalId() == 0 && index.row() < m_contexts.size();
+}
+
+QString TsTreeModel::contextName(const QModelIndex &index) const {
+    if (!index.isValid()) {
+        return QString();
+    }
+    int contextRow = isContext(index) ? index.row() : static_cast<int>(index.internalId() - 1);
+    return contextRow < m_contexts.size() ? m_contexts.at(contextRow).name : QString();
+}
+
+int TsTreeModel::entryIndex(const QModelIndex &index) const {
+    if (!index.isValid() || index.internalId() == 0) {
+        return -1;
+    }
+    int contextRow = static_cast<int>(index.internalId() - 1);
+    if (contextRow >= m_contexts.size() || index.row() >= m_contexts.at(contextRow).entries.size()) {
+        return -1;
+    }
+    return m_contexts.at(contextRow).entries.at(index.row());
+}
+
+QModelIndex TsTreeModel::indexForEntry(int entryIndex) {
+    if (entryIndex < 0 || entryIndex >= m_entryContext.size()) {
+        return QModelIndex();
+    }
+    int contextRow = m_entryContext.at(entryIndex);
+    int row = m_entryRow.at(entryIndex);
+    QModelIndex contextIndex = index(contextRow, 0);
+    while (m_contexts.at(contextRow).fetched <= row) {
+        fetchMore(contextIndex);
+    }
+    return index(row, 0, contextIndex);
+}
+
+QVariant TsTreeModel::data(const QModelIndex &index, int role) const {
+    if (!index.isValid()) {
+        return QVariant();
+    }
+
+    if (isContext(index)) {
+        const ContextNode &node = m_contexts.at(index.row());
+        if (role == Qt::UserRole && index.column() == 0) {
+            return node.name;
+        }
+        if (index.column() == 0 && role == Qt::DisplayRole) {
+            return node.name;
+        }
+        if (index.column() == 2) {
+            int total = node.entries.size();
+            if (role == Qt::DisplayRole) {
+                return QString("%1/%2").arg(node.finished).arg(total);
+            }
+            if (role == Qt::ForegroundRole) {
+                double progress = total > 0 ? (double)node.finished / total : 0;
+                if (progress < 0.3) return QColor(200, 0, 0);
+                if (progress < 0.7) return QColor(200, 150, 0);
+                return QColor(0, 150, 0);
+            }
+        }
+        return QVariant();
+    }
+
+    int entry = entryIndex(index);
+    if (entry < 0 || entry >= m_fileHandler->entries().size()) {
+        return QVariant();
+    }
+    const TsEntry &tsEntry = m_fileHandler->entries().at(entry);
+
+    switch (role) {
+        case Qt::DisplayRole:
+            if (index.column() == 1) {
+                // 行高统一，多行源文本折叠为一行显示
+                QString text = tsEntry.source;
+                return text.replace('\n', QStringLiteral(" ↵ "));
+            }
+            if (index.column() == 2) {
+                return stateToString(tsEntry.state);
+            }
+            return QVariant();
+        case Qt::ToolTipRole:
+            return index.column() == 1 ? QVariant(tsEntry.source) : QVariant();
+        case Qt::ForegroundRole:
+            if (index.column() != 2) return QVariant();
+            if (tsEntry.state == TranslationState::Unfinished) return QColor(200, 0, 0);
+            if (tsEntry.state == TranslationState::Obsolete) return QColor(150, 150, 150);
+            return QColor(0, 150, 0);
+        case Qt::UserRole:
+            return index.column() == 1 ? QVariant(tsEntry.source) : QVariant();
+        case EntryIndexRole:
+            return entry;
+        case StateRole:
+            return static_cast<int>(tsEntry.state);
+        case SourceLengthRole:
+            return tsEntry.source.size();
+        default:
+            return QVariant();
+    }
+}
+
+QVariant TsTreeModel::headerData(int section, Qt::Orientation orientation, int role) const {
+    if (orientation != Qt::Horizontal || role != Qt::DisplayRole) {
+        return QVariant();
+    }
+    switch (section) {
+        case 0: return "上下文";
+        case 1: return "源文本";
+        case 2: return "状态";
+    }
+    return QVariant();
+}
+
+Qt::ItemFlags TsTreeModel::flags(const QModelIndex &index) const {
+    if (!index.isValid()) {
+        return Qt::NoItemFlags;
+    }
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable;
+}
+
+void TsTreeModel::onEntryUpdated(int entryIndex) {
+    if (entryIndex < 0 || entryIndex >= m_entryContext.size()
+        || entryIndex >= m_fileHandler->entries().size()) {
+        return;
+    }
+
+    int contextRow = m_entryContext.at(entryIndex);
+    ContextNode &node = m_contexts[contextRow];
+
+    // 重新统计该上下文（只遍历本上下文）
+    countContext(node);
+
+    QModelIndex contextIndex = index(contextRow, 2);
+    emit dataChanged(contextIndex, contextIndex);
+
+    int row = m_entryRow.at(entryIndex);
+    if (row < node.fetched) {
+        QModelIndex parentIndex = index(contextRow, 0);
+        emit dataChanged(index(row, 0, parentIndex), index(row, 2, parentIndex));
+    }
+}
+
+void TsTreeModel::onEntriesUpdated(int first, int last) {
+    first = qMax(first, 0);
+    last = qMin(last, qMin(m_entryContext.size(), m_fileHandler->entries().size()) - 1);
+
+    // 每个上下文只重新统计一次，已加载的消息行合并为一个 dataChanged 区间
+    QHash<int, QPair<int, int>> rows;   // 上下文行 -> (最小行, 最大行)
+    for (int entry = first; entry <= last; ++entry) {
+        const int contextRow = m_entryContext.at(entry);
+        const int row = m_entryRow.at(entry);
+        auto it = rows.find(contextRow);
+        if (it == rows.end()) {
+            rows.insert(contextRow, qMakePair(row, row));
+        } else {
+            it.value().first = qMin(it.value().first, row);
+            it.value().second = qMax(it.value().second, row);
+        }
+    }
+
+    for (auto it = rows.constBegin(); it != rows.constEnd(); ++it) {
+        const int contextRow = it.key();
+        ContextNode &node = m_contexts[contextRow];
+        countContext(node);
+
+        QModelIndex contextIndex = index(contextRow, 2);
+        emit dataChanged(contextIndex, contextIndex);
+
+        const int lastRow = qMin(it.value().second, node.fetched - 1);
+        if (it.value().first <= lastRow) {
+            QModelIndex parentIndex = index(contextRow, 0);
+            emit dataChanged(index(it.value().first, 0, parentIndex), index(lastRow, 2, parentIndex));
+        }
+    }
+}
+
+void TsTreeModel::onEntryAdded(int entryIndex) {
+    const EntryStore &entries = m_fileHandler->entries();
+    // 只增量处理追加到末尾的条目，其他情况整体重建
+    if (entryIndex != m_entryContext.size() || entryIndex != entries.size() - 1) {
+        rebuild();
+        return;
+    }
+
+    const QString &context = entries.at(entryIndex).context;
+    int contextRow = m_contextRows.value(context, -1);
+    if (contextRow < 0) {
+        contextRow = m_contexts.size();
+        beginInsertRows(QModelIndex(), contextRow, contextRow);
+        ContextNode node;
+        node.name = context;
+        m_contexts.append(node);
+        m_contextRows.insert(context, contextRow);
+        endInsertRows();
+    }
+
+    ContextNode &node = m_contexts[contextRow];
+    m_entryContext.append(contextRow);
+    m_entryRow.append(node.entries.size());
+    // 已全部加载的上下文直接插入新行，否则留给 fetchMore
+    if (node.fetched == node.entries.size()) {
+        beginInsertRows(index(contextRow, 0), node.fetched, node.fetched);
+        node.entries.append(entryIndex);
+        node.fetched++;
+        endInsertRows();
+    } else {
+        node.entries.append(entryIndex);
+    }
+
+    countContext(node);
+    emit dataChanged(index(contextRow, 0), index(contextRow, 2));
+}
+
+void TsTreeModel::onEntriesRemoved(const QVector<int> &indices) {
+    if (indices.isEmpty() || indices.last() >= m_entryContext.size()
+        || m_entryContext.size() != m_fileHandler->entries().size() + indices.size()) {
+        rebuild();
+        return;
+    }
+
+    // 按上下文收集被删的行，各上下文内为升序
+    QMap<int, QVector<int>> removedRows;
+    for (int entry : indices) {
+        removedRows[m_entryContext.at(entry)].append(m_entryRow.at(entry));
+    }
+    std::for_each(removedRows.begin(), removedRows.end(), [](QVector<int> &rows) {
+        std::sort(rows.begin(), rows.end());
+    });
+
+    // 先一次性把全部下标换成删除后的编号，被删条目记为 -1（data() 对其返回空值）
+    for (ContextNode &node : m_contexts) {
+        for (int &entry : node.entries) {
+            entry = TsFileHandler::remapIndex(indices, entry);
+        }
+    }
+
+    // 每个上下文从后往前按连续行区间删除，已加载的区间各发出一次 rowsRemoved
+    for (auto it = removedRows.cbegin(); it != removedRows.cend(); ++it) {
+        const int contextRow = it.key();
+        const QVector<int> &rows = it.value();
+        ContextNode &node = m_contexts[contextRow];
+        int end = rows.size();
+        while (end > 0) {
+            int begin = end - 1;
+            while (begin > 0 && rows.at(begin - 1) == rows.at(begin) - 1) {
+                --begin;
+            }
+            const int first = rows.at(begin);
+            const int last = rows.at(end - 1);
+            const int visibleLast = qMin(last, node.fetched - 1);
+            if (first <= visibleLast) {
+                beginRemoveRows(index(contextRow, 0), first, visibleLast);
+            }
+            node.entries.remove(first, last - first + 1);
+            if (first <= visibleLast) {
+                node.fetched -= visibleLast - first + 1;
+                endRemoveRows();
+            }
+            end = begin;
+        }
+    }
+
+    // 重建条目到上下文行与行号的映射
+    const int count = m_fileHandler->entries().size();
+    m_entryContext.resize(count);
+    m_entryRow.resize(count);
+    for (int contextRow = 0; contextRow < m_contexts.size(); ++contextRow) {
+        const QVector<int> &entries = m_contexts.at(contextRow).entries;
+        for (int row = 0; row < entries.size(); ++row) {
+            m_entryContext[entries.at(row)] = contextRow;
+            m_entryRow[entries.at(row)] = row;
+        }
+    }
+
+    // 已空的上下文保留该行（消息行的 internalId 依赖上下文行号），筛选代理会将其隐藏
+    for (auto it = removedRows.cbegin(); it != removedRows.cend(); ++it) {
+        countContext(m_contexts[it.key()]);
+        emit dataChanged(index(it.key(), 0), index(it.key(), 2));
+    }
+}
+
+bool TsTreeModel::entryMatches(const TsEntry &entry, Filter filter) {
+    switch (filter) {
+        case AllEntries:
+            return true;
+        case UnfinishedEntries:
+            return entry.state == TranslationState::Unfinished || entry.translation.isEmpty();
+        case NeedsReviewEntries:
+            return entry.state == TranslationState::Unfinished && !entry.translation.isEmpty();
+        case ObsoleteEntries:
+            return entry.state == TranslationState::Obsolete || entry.state == TranslationState::Vanished;
+    }
+    return true;
+}
+
+void TsTreeModel::countContext(ContextNode &node) const {
+    node.finished = 0;
+    node.unfinished = 0;
+    node.needsReview = 0;
+    node.obsolete = 0;
+
+    const EntryStore &entries = m_fileHandler->entries();
+    for (int entry : std::as_const(node.entries)) {
+        const TsEntry &tsEntry = entries.at(entry);
+        if (tsEntry.state == TranslationState::Finished) node.finished++;
+        if (entryMatches(tsEntry, UnfinishedEntries)) node.unfinished++;
+        if (entryMatches(tsEntry, NeedsReviewEntries)) node.needsReview++;
+        if (entryMatches(tsEntry, ObsoleteEntries)) node.obsolete++;
+    }
+}
+
+int TsTreeModel::contextMatchCount(int contextRow, Filter filter) const {
+    if (contextRow < 0 || contextRow >= m_contexts.size()) {
+        return 0;
+    }
+    const ContextNode &node = m_contexts.at(contextRow);
+    switch (filter) {
+        case AllEntries: return node.entries.size();
+        case UnfinishedEntries: return node.unfinished;
+        case NeedsReviewEntries: return node.needsReview;
+        case ObsoleteEntries: return node.obsolete;
+    }
+    return node.entries.size();
+}
+
+QString TsTreeModel::stateToString(TranslationState state) const {
+    switch (state) {
+        case TranslationState::Unfinished: return "未完成";
+        case TranslationState::Finished: return "已完成";
+        case TranslationState::Vanished: return "已消失";
+        case TranslationState::Obsolete: return "已废弃";
+        default: return "未知";
+    }
+}
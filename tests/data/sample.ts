@@ -0,0 +1,68 @@
+<?xml version="1.0" encoding="utf-8"?>
+<!DOCTYPE TS>
+<TS version="2.1" language="zh_CN">
+<context>
+    <name>MainWindow</name>
+    <message>
+        <location filename="../src/mainwindow.cpp" line="42"/>
+        <source>&amp;File</source>
+        <translation>文件(&amp;F)</translation>
+    </message>
+    <message>
+        <location filename="../src/mainwindow.cpp" line="57"/>
+        <source>Open %1</source>
+        <translation>打开 %1</translation>
+    </message>
+    <message>
+        <location filename="../src/mainwindow.cpp" line="63"/>
+        <source>Save</source>
+        <translation type="unfinished">保存</translation>
+    </message>
+    <message>
+        <location filename="../src/mainwindow.cpp" line="71"/>
+        <source>Close</source>
+        <translation type="unfinished"></translation>
+    </message>
+    <message>
+        <source>Old action</source>
+        <translation type="obsolete">旧操作</translation>
+    </message>
+    <message>
+        <source>Removed action</source>
+        <translation type="vanished">已删除的操作</translation>
+    </message>
+</context>
+<context>
+    <name>SettingsDialog</name>
+    <message>
+        <location filename="../src/settingsdialog.cpp" line="18"/>
+        <source>Apply</source>
+        <comment>button</comment>
+        <translation>应用</translation>
+    </message>
+    <message>
+        <location filename="../src/settingsdialog.cpp" line="25"/>
+        <source>Apply</source>
+        <comment>menu</comment>
+        <translation>应用设置</translation>
+    </message>
+    <message>
+        <location filename="../src/settingsdialog.cpp" line="31"/>
+        <source>OK</source>
+        <translation>确定</translation>
+    </message>
+    <message>
+        <location filename="../src/settingsdialog.cpp" line="36"/>
+        <source>OK</source>
+        <comment>default button</comment>
+        <translation>默认确定</translation>
+    </message>
+    <message>
+        <location filename="../src/settingsdialog.cpp" line="44"/>
+        <source>Line one
+Line two with &lt;b&gt;markup&lt;/b&gt; &amp; &quot;quotes&quot;</source>
+        <translation>第一行
+第二行含 &lt;b&gt;标记&lt;/b&gt; 与“引号”</translation>
+    </message>
+</context>
+</TS>
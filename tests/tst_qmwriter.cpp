@@ -0,0 +1,71 @@
+#include <QtTest>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTranslator>
+#include "qmwriter.h"
+#include "tsfilehandler.h"
+
+// QmWriter 生成的 .qm 必须能被 QTranslator 正确查找，并与 lrelease 的输出一致
+class TestQmWriter : public QObject {
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+    void translatorFindsEveryMessage();
+    void matchesLrelease();
+
+private:
+    QString m_tsPath;
+    TsFileHandler m_handler;
+};
+
+void TestQmWriter::initTestCase() {
+    m_tsPath = QFINDTESTDATA("data/sample.ts");
+    QVERIFY(!m_tsPath.isEmpty());
+    QVERIFY(m_handler.load(m_tsPath));
+    QVERIFY(!m_handler.entries().isEmpty());
+}
+
+void TestQmWriter::translatorFindsEveryMessage() {
+    const QByteArray qm = QmWriter::compile(m_handler.language(), m_handler.snapshot());
+    QTranslator translator;
+    QVERIFY(translator.load(reinterpret_cast<const uchar *>(qm.constData()), qm.size()));
+
+    for (const TsEntry &entry : m_handler.entries()) {
+        // 已完成与有译文的未完成条目会被发布，已废弃/已消失条目查不到
+        const bool released = entry.state == TranslationState::Finished
+                              || (entry.state == TranslationState::Unfinished && !entry.translation.isEmpty());
+        const QString expected = released ? entry.translation : QString();
+
+        const QByteArray context = entry.context.toUtf8();
+        const QByteArray source = entry.source.toUtf8();
+        const QByteArray comment = entry.comments.value(0).toUtf8();
+        const QString actual = translator.translate(context.constData(), source.constData(),
+                                                    comment.isEmpty() ? nullptr : comment.constData());
+        QVERIFY2(actual == expected,
+                 qPrintable(QString("%1 / %2 / %3: \"%4\" != \"%5\"")
+                            .arg(entry.context, entry.source, entry.comments.value(0), actual, expected)));
+    }
+}
+
+void TestQmWriter::matchesLrelease() {
+#ifndef LRELEASE_EXECUTABLE
+    QSKIP("未找到 lrelease，跳过逐字节比较");
+#else
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    const QString qmPath = dir.filePath("sample.qm");
+
+    QProcess lrelease;
+    lrelease.start(QStringLiteral(LRELEASE_EXECUTABLE), {"-silent", m_tsPath, "-qm", qmPath});
+    QVERIFY(lrelease.waitForFinished());
+    QCOMPARE(lrelease.exitCode(), 0);
+
+    QFile file(qmPath);
+    QVERIFY(file.open(QIODevice::ReadOnly));
+    QCOMPARE(QmWriter::compile(m_handler.language(), m_handler.snapshot()), file.readAll());
+#endif
+}
+
+QTEST_GUILESS_MAIN(TestQmWriter)
+#include "tst_qmwriter.moc"